@@ -1,9 +1,18 @@
 #ifndef CELLULAR_APP_H
 #define CELLULAR_APP_H
 
+#include <filesystem>
+#include <optional>
+#include <string>
+
 #include <cell/alias.hpp>
 #include <cell/cell.hpp>
-#include <cell/shader.hpp>
+#include <cell/governor.hpp>
+#include <cell/gpu_timer.hpp>
+#include <cell/metrics.hpp>
+#include <cell/render.hpp>
+#include <cell/simulation.hpp>
+#include <cell/stats.hpp>
 
 namespace cell {
 
@@ -12,47 +21,123 @@ static constexpr i32 WINDOW_HEIGHT = 900;
 static constexpr f32 ASPECT_RATIO =
     static_cast<f32>(WINDOW_WIDTH) / static_cast<f32>(WINDOW_HEIGHT);
 
-struct Stats {
-    usize update_count{};
-    usize draw_count{};
-    f64   update_time{};
-    f64   draw_time{};
+// Options of run_headless.
+struct HeadlessOptions {
+    // directory the images are written to
+    std::filesystem::path output      = "frames";
+    u32                   generations = 100;
+    // generations between two images
+    u32                   every     = 10;
+    u32                   width     = WINDOW_WIDTH;
+    u32                   height    = WINDOW_HEIGHT;
+    u8                    dimension = 100;
+    // rule of the keys '1' to '4'
+    u8                    rule = 3;
+    // file the latencies are written to every STATS_INTERVAL, see
+    // StatsWriter
+    std::optional<std::filesystem::path> stats;
+    // file the trace zones are dumped to at the end, see start_tracing
+    std::optional<std::filesystem::path> trace;
+    // count hardware events next to the latencies, see start_counters
+    bool                                 counters{};
+    // port or Unix socket the metrics are served on, see MetricsServer
+    std::optional<std::string>           metrics;
+    // map the grids from reserved huge pages, see use_reserved_huge_pages
+    bool                                 huge_pages{};
+    // engine computing the generations, see prefer_engine
+    std::optional<LifeEngine>            engine;
+};
+
+// Runs Life without a window or a GPU, ray-casting it on the CPU into a
+// numbered PPM image every few generations.
+void run_headless(HeadlessOptions const &options);
+
+// Options of AppState::record.
+struct RecordOptions {
+    // a .y4m file, or else a directory of numbered PPM files
+    std::filesystem::path output = "cellular.y4m";
+    u32                   frames = 300;
+    // rule of the keys '1' to '4'
+    u8                    rule = 3;
+};
+
+// Options of AppState::run.
+struct RunOptions {
+    // seconds of each frame the simulation may take on the render thread,
+    // which otherwise runs it on a thread of its own
+    std::optional<f64> budget;
+    // seconds per frame the governor holds frames to
+    f64                frame_target = 1.0 / 60.0;
+    // file the latencies are written to every STATS_INTERVAL, see
+    // StatsWriter
+    std::optional<std::filesystem::path> stats;
+    // file the trace zones are dumped to on the key 'T' and at the end, see
+    // start_tracing
+    std::optional<std::filesystem::path> trace;
+    // count hardware events next to the latencies, see start_counters
+    bool                                 counters{};
+    // port or Unix socket the metrics are served on, see MetricsServer
+    std::optional<std::string>           metrics;
+    // map the grids from reserved huge pages, see use_reserved_huge_pages
+    bool                                 huge_pages{};
+    // engine computing the generations, see prefer_engine
+    std::optional<LifeEngine>            engine;
+};
+
+enum class RenderMode : u8 {
+    Cubes,
+    Points,
+    Chunks,
+    Volume,
 };
 
 class AppState {
-    Stats       stats{};
-    Life        life;
-    GLFWwindow *window;
-    glm::mat4x4 projection;
-    LifeRule    life_rule;
-    usize       update_rate = 4;
-    Shader      shader_program;
-    GLuint      VAO{};
-    GLuint      position_buffer{};
-    GLuint      color_buffer{};
-    GLint       mvp_location;
-    GLint       vertex_position;
-    GLint       vertex_color;
-    bool        full_init = true;
-
-    AppState(AppState const &)                     = default;
-    AppState(AppState &&)                          = default;
-    auto operator=(AppState const &) -> AppState & = default;
-    auto operator=(AppState &&) -> AppState &      = default;
-
-    void restart();
-    void render() const;
-    void update(usize value);
+    Stats          stats{};
+    GLFWwindow    *window;
+    // rule of the world being shown, for its colours
+    LifeRule       life_rule;
+    CubeRenderer   cube_renderer;
+    PointRenderer  point_renderer;
+    ChunkRenderer  chunk_renderer;
+    VolumeRenderer volume_renderer;
+    RenderMode     render_mode = RenderMode::Chunks;
+    // level of detail bias of the keys '[' and ']'
+    f32            lod_bias{};
+    Governor       governor;
+    GpuTimers      gpu_timers;
+    ScaledTarget   scaled_target;
+    Simulation     simulation;
+
+    AppState(AppState const &)                     = delete;
+    AppState(AppState &&)                          = delete;
+    auto operator=(AppState const &) -> AppState & = delete;
+    auto operator=(AppState &&) -> AppState &      = delete;
+
+    void render(f32 time, glm::vec2 viewport);
+    // Gathers the generations of the simulation, writes the latencies since
+    // the last call if there is a writer, publishes them if there is a
+    // metrics server, and adds them to the totals.
+    void flush_stats(
+        std::optional<StatsWriter>   &writer,
+        std::optional<MetricsServer> &metrics,
+        f64                           time
+    );
 
     friend void
     keyboard(GLFWwindow *window, int key, int scancode, int action, int mods);
     friend void scroll(GLFWwindow *window, double xoffset, double yoffset);
 
   public:
-    AppState();
+    explicit AppState(bool visible = true);
     ~AppState();
 
-    void run();
+    // Shows the world while the simulation runs on a thread of its own, or,
+    // given a budget, in slices after each frame. The governor holds frames
+    // to the target time.
+    void run(RunOptions const &options);
+    // Renders options.frames generations into an offscreen framebuffer and
+    // encodes them to options.output, without showing the window.
+    void record(RecordOptions const &options);
 };
 
 } // namespace cell
@@ -0,0 +1,80 @@
+#ifndef CELLULAR_ARENA_H
+#define CELLULAR_ARENA_H
+
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <cell/alias.hpp>
+
+namespace cell {
+
+// Alignment of every block of the arena, a cache line, so rows of cells
+// start on one.
+static constexpr usize GRID_ALIGNMENT = 64;
+
+// Size of a huge page on x86-64 and most of aarch64.
+static constexpr usize HUGE_PAGE_SIZE = usize{2} << 20U;
+
+// Blocks of at least this many bytes are mapped from the kernel, aligned
+// to a page, and to a huge page once they span one. Smaller ones come from
+// the heap.
+static constexpr usize MIN_MAPPED_SIZE = usize{64} << 10U;
+
+// Mapped blocks kept for reuse once freed, enough for the grids of the
+// simulation and its three snapshots.
+static constexpr usize ARENA_CACHE_SIZE = 8;
+
+// Gives a zeroed block of bytes, aligned to GRID_ALIGNMENT. A block mapped
+// for it is zero already, while a freed one of the same size is reused and
+// cleared, so it costs a memset but no page faults.
+[[nodiscard]] auto arena_allocate(usize bytes) -> void *;
+void               arena_deallocate(void *block, usize bytes) noexcept;
+
+// Maps blocks spanning a huge page from the huge pages reserved through
+// /proc/sys/vm/nr_hugepages, rather than asking for transparent ones, and
+// falls back to those once the reserve runs out.
+void use_reserved_huge_pages();
+
+// Allocator of the vectors of a Life. Elements are default initialised,
+// which leaves the zeroed blocks of the arena as they are instead of
+// writing every byte again.
+template <typename T> class GridAllocator {
+  public:
+    using value_type = T;
+
+    GridAllocator() = default;
+
+    template <typename U>
+    constexpr GridAllocator(GridAllocator<U> const & /*other*/) noexcept {}
+
+    [[nodiscard]] auto allocate(usize n) -> T * {
+        static_assert(alignof(T) <= GRID_ALIGNMENT);
+        return static_cast<T *>(arena_allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *block, usize n) noexcept {
+        arena_deallocate(block, n * sizeof(T));
+    }
+
+    template <typename U> void construct(U *element) {
+        ::new (static_cast<void *>(element)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U *element, Args &&...args) {
+        ::new (static_cast<void *>(element)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    constexpr auto operator==(GridAllocator<U> const & /*other*/) const
+        -> bool {
+        return true;
+    }
+};
+
+template <typename T> using GridVector = std::vector<T, GridAllocator<T>>;
+
+} // namespace cell
+
+#endif
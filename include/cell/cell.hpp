@@ -2,59 +2,334 @@
 #define CELLULAR_CELL_H
 
 #include <cell/alias.hpp>
+#include <cell/arena.hpp>
+#include <cell/memory.hpp>
+#include <array>
 #include <functional>
+#include <span>
+#include <string_view>
+#include <vector>
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 
 namespace cell {
 
-using CellState   = u8;
-using LifeRuleFn  = std::function<bool(u8)>;
-using CellColorFn = std::function<
-    glm::vec3(f32 max_distance, u8 dimension, CellState, u8 x, u8 y, u8 z)>;
+using CellState  = u8;
+using LifeRuleFn = std::function<bool(u8)>;
+
+static constexpr u8 THREAD_COUNT = 16;
+
+// Side length of the cubes the world is split into for change tracking.
+static constexpr u8 CHUNK_SIZE = 16;
+
+// Levels of the occupancy pyramid above the cells themselves. Each level
+// halves the previous one, so the coarsest has one cell per chunk.
+static constexpr u8 LOD_LEVELS = 4;
+
+static constexpr usize MAX_PALETTE_SIZE = 16;
+
+// Cells along an axis of the largest world, whose coordinates are bytes.
+static constexpr usize MAX_AXIS = 256;
+
+// Coordinates first to first + length - 1 of an axis, wrapping around the
+// world past its last cell.
+struct AxisRange {
+    u8  first;
+    u16 length;
+};
+
+// A range of x, y and z.
+using LiveBox = std::array<AxisRange, 3>;
+
+// Whether each x, y and z holds a live cell.
+using LiveMarks = std::array<std::array<u8, MAX_AXIS>, 3>;
+
+// Live cells at each x, y and z.
+using LiveCounts = std::array<std::array<u32, MAX_AXIS>, 3>;
+
+// Rules with at most this many states fit a cell in a nibble.
+static constexpr u8 NIBBLE_STATES = 16;
+
+// Bytes of the cells and planes of the Planes engine past which rules that
+// fit a nibble run on the Nibbles engine, slower but without the cells
+// besides its two packed grids, see Life::select_engine.
+static constexpr usize PLANES_MEMORY_LIMIT = usize{16} << 20U;
+
+// How Life reads a generation while computing the next one, picked from
+// its dimension and the states of the rule it was last initialised with,
+// see select_engine.
+enum class LifeEngine : u8 {
+    Bytes,    // from the cells, into a second grid of bytes
+    Nibbles,  // from the cells packed two to a byte, see update_nibble_slabs
+    Planes,   // from the bits of the cells 64 to a word, see
+              // update_plane_slabs
+    Counts,   // from counts of live neighbours kept as cells are born and
+              // die, only where those changed, see update_count_slabs
+    Frontier, // from the cells, only around those that changed, see
+              // update_frontier_slabs
+};
+
+static constexpr usize ENGINE_COUNT = 5;
+
+static constexpr std::array<std::string_view, ENGINE_COUNT> ENGINE_NAMES = {
+    "bytes", "nibbles", "planes", "counts", "frontier",
+};
+
+// Makes every Life use engine from its next initialisation on, for the
+// rules it can run. Call before any Life is initialised.
+void prefer_engine(LifeEngine engine);
+
+// How the shader derives a cell colour, see shader/shader.vert. The distance
+// gradients use the squared distance from the centre of the world, divided
+// by Life::get_max_distance.
+enum class ColorGradient : u8 {
+    State,        // palette[state]
+    Distance,     // mix(from, to, distance)
+    DistanceSqrt, // mix(from, to, sqrt(distance))
+    Position,     // position / dimension as rgb
+};
+
+struct CellColor {
+    ColorGradient                           gradient;
+    std::array<glm::vec3, MAX_PALETTE_SIZE> palette{};
+    glm::vec3                               from{};
+    glm::vec3                               to{};
+};
+
+// Per-instance record uploaded to the renderer: x, y, z and state packed
+// into one byte each, from least to most significant.
+[[nodiscard]] constexpr auto pack_cell(u8 x, u8 y, u8 z, CellState state)
+    -> u32 {
+    return static_cast<u32>(x) | (static_cast<u32>(y) << 8U) |
+           (static_cast<u32>(z) << 16U) | (static_cast<u32>(state) << 24U);
+}
+
+// Bytes of a Life, see Life::estimate_memory.
+struct LifeMemory {
+    usize grid;
+    usize scratch;
+};
 
 struct LifeRule {
-    LifeRuleFn  alive_rule;
-    LifeRuleFn  dead_rule;
-    CellColorFn cell_color;
-    u8          state_count;
-    f64         start_dead_chance;
+    LifeRuleFn alive_rule;
+    LifeRuleFn dead_rule;
+    CellColor  cell_color;
+    u8         state_count;
+    f64        start_dead_chance;
 };
 
 class Life {
-    std::vector<CellState> cells;
+    // the cells, except with the Nibbles engine, which keeps them in packed
+    // only, see load
+    GridVector<CellState>  cells;
+    // level n + 1 of the pyramid holds, for each 2x2x2 block of level n, its
+    // most common live state, or 0 if the whole block is dead
+    std::array<GridVector<CellState>, LOD_LEVELS> pyramid;
+    // generation in which a cell of each chunk last changed
+    std::vector<u64>       chunk_stamps;
+    // the next generation, computed a slab of constant z at a time and
+    // swapped with cells once complete
+    GridVector<CellState>  next_cells;
+    // whether a cell of each chunk changes in the next generation
+    std::vector<u8>        next_touched;
+    // the cells two to a byte, low nibble first, with the Nibbles engine,
+    // which reads a generation from packed and writes the next one to
+    // next_packed
+    GridVector<u8>         packed;
+    GridVector<u8>         next_packed;
+    // with the Planes engine, every row as a plane of whether each of its
+    // cells is alive followed by plane_count planes of the bits of their
+    // states, each plane a row of words, bit x of a row in word x / 64
+    GridVector<u64>        planes;
+    GridVector<u64>        next_planes;
+    // with the Counts engine, the live neighbours of every cell, and
+    // whether each cell is already in next_candidates
+    GridVector<u8>         counts;
+    GridVector<u8>         queued;
+    // for each slab, the cells whose state or count changed in the last
+    // generation, the only ones the next can change, and those of the next
+    std::vector<std::vector<u32>> candidates;
+    std::vector<std::vector<u32>> next_candidates;
+    // with the Frontier engine, a bit for each cell, set if a cell of its
+    // 3x3x3 changed in the last generation, the only ones the next can
+    // change, and those of the next
+    GridVector<u64>        active;
+    GridVector<u64>        next_active;
+    // for each slab, the cells changing in the generation being computed
+    // and their next states, written to the cells once it completes
+    struct Change {
+        u32       index;
+        CellState state;
+    };
+    std::vector<std::vector<Change>> changes;
+    // with the Counts and Frontier engines, for each slab, the cells born or
+    // dead in the generation being computed, which move the live_counts,
+    // and the counts of their neighbours, once it completes
+    std::vector<std::vector<u32>> flips;
+    // whether every cell of each slab is computed in the next generation,
+    // as the candidates do not hold after the cells or the rule change
+    std::vector<u8>        stale_slabs;
+    LiveCounts             live_counts{};
+    // the rule the candidates were found with, bit n of each mask set if it
+    // gives birth or keeps alive at n live neighbours
+    u32                    born_mask{};
+    u32                    survive_mask{};
+    CellState              newborn{};
+    LifeEngine             engine{};
+    u8                     plane_count{};
+    // smallest ranges of x, y and z holding every live cell, each wrapping
+    // around the world where that is shorter
+    LiveBox                live_box{};
+    // of the next generation
+    LiveMarks              next_live{};
+    // slabs of the next generation already computed
+    u8                     next_slab{};
+    u64                    generation{};
     f32                    max_distance{};
     u8                     dimension{};
+    u8                     chunk_count{};
+    MemoryAccount          grid_memory{Memory::Grid};
+    MemoryAccount          scratch_memory{Memory::Scratch};
 
     [[nodiscard]] constexpr auto count_neighbours(u8 x, u8 y, u8 z) const -> u8;
 
     [[nodiscard]] constexpr auto get(u8 x, u8 y, u8 z) const -> CellState;
     auto set(u8 x, u8 y, u8 z, CellState state) -> CellState;
+    // state of the cell at idx, from packed with the Nibbles engine
+    [[nodiscard]] constexpr auto load(u32 idx) const -> CellState;
+    void store(u32 idx, CellState state);
 
     [[nodiscard]] constexpr auto idx(u8 x, u8 y, u8 z) const -> u32;
     [[nodiscard]] constexpr auto reverse_idx(u32 idx) const
         -> std::array<u8, 3>;
 
-    void update_worker(
-        Life const &clone, LifeRule const &rule, u32 lower, u32 upper
+    void touch_chunk(u8 x, u8 y, u8 z);
+    void touch_all();
+    // Finds the live_box of the cells by scanning them all.
+    void bound_live();
+    // Adds the x, y and z of live cells of the next generation a worker
+    // found to next_live.
+    void mark_live(LiveMarks const &live);
+    // live_box grown by the cell around it a generation can change, or the
+    // whole world if rule gives birth to cells without live neighbours
+    [[nodiscard]] auto get_update_box(LifeRule const &rule) const -> LiveBox;
+    void build_pyramid(u32 chunk);
+    void build_pyramid();
+
+    // Sizes the grids engine computes generations with, for states of
+    // plane_count bits, and frees the others, the cells too with Nibbles.
+    void set_engine(LifeEngine engine, u8 plane_count);
+    // Copies the cells into planes, or counts their neighbours, for engines
+    // reading those.
+    void pack();
+    // Counts the live cells at each coordinate, and the live neighbours of
+    // every cell with the Counts engine, and has every cell computed in the
+    // next generation.
+    void recount();
+    // Makes the Counts and Frontier engines compute every cell again if rule
+    // differs from the one they last computed with.
+    void load_rule(LifeRule const &rule);
+
+    // words of a row of a plane
+    [[nodiscard]] constexpr auto get_row_words() const -> u32 {
+        return (this->dimension + 63U) / 64U;
+    }
+    void account_memory();
+
+    // Compute the slabs lower to upper of the next generation, within box,
+    // marking the coordinates of its live cells in live.
+    void update_slabs(LifeRule const &rule, u8 lower, u8 upper);
+    void update_byte_slabs(
+        LifeRule const &rule,
+        LiveBox const  &box,
+        u8              lower,
+        u8              upper,
+        LiveMarks      &live
+    );
+    void update_nibble_slabs(
+        LifeRule const &rule,
+        LiveBox const  &box,
+        u8              lower,
+        u8              upper,
+        LiveMarks      &live
     );
+    void update_plane_slabs(
+        LifeRule const &rule,
+        LiveBox const  &box,
+        u8              lower,
+        u8              upper,
+        LiveMarks      &live
+    );
+    void update_count_slabs(LiveBox const &box, u8 lower, u8 upper);
+    void update_frontier_slabs(LiveBox const &box, u8 lower, u8 upper);
+    // Calls visit with the index of every cell of slab z within box.
+    template <typename Visit>
+    void for_box(LiveBox const &box, u32 z, Visit const &visit) const;
+    // Completes the slabs lower to upper once every slab of the generation
+    // is computed, with the engines that defer work to then: moves their
+    // counts by the flips with Counts, writes their changes with Frontier.
+    void settle_slabs(u8 lower, u8 upper);
+    void count_flips(u8 lower, u8 upper);
+    void apply_changes(u8 lower, u8 upper);
+    // Moves live_counts by the flips of the generation completed.
+    void count_live();
+    void finish_update();
+
+    // empty, for get_view to fill
+    Life() = default;
 
   public:
     explicit Life(u8 dimension);
 
+    // Bytes a Life of dimension takes with a rule of state_count states,
+    // before making one.
+    [[nodiscard]] static auto estimate_memory(u8 dimension, u8 state_count)
+        -> LifeMemory;
+    // Bytes of a view of a Life of dimension, see copy_view_to.
+    [[nodiscard]] static auto estimate_view_memory(u8 dimension)
+        -> LifeMemory;
+    // engine of the rules with state_count states in a world of dimension,
+    // the one preferred if it can run them, else Planes, or Nibbles where
+    // Planes would pass PLANES_MEMORY_LIMIT
+    [[nodiscard]] static auto select_engine(u8 dimension, u8 state_count)
+        -> LifeEngine;
+
+    // Sizes the world for dimension, leaving its cells and the grids of its
+    // engine to the init every caller runs next. The cells of a new Life are
+    // all dead.
     void               resize(u8 dimension);
     void               init_center_random(u8 state_count, f64 dead_chance);
     void               init_full_random(u8 state_count, f64 dead_chance);
+    // Completes the next generation on THREAD_COUNT threads.
     void               update(LifeRule const &rule);
-    [[nodiscard]] auto draw(CellColorFn const &cell_color) const
-        -> std::array<std::vector<glm::vec3>, 2>;
+    // Computes up to slabs more slabs of the next generation on the calling
+    // thread, and returns true once the generation is complete and has
+    // replaced the cells.
+    auto               advance(LifeRule const &rule, u8 slabs) -> bool;
+    [[nodiscard]] auto draw() const -> std::vector<u32>;
+
+    // Copies what draw and the getters read into view, the cells, unpacked
+    // with the Nibbles engine, pyramid, chunk stamps and live box, but none
+    // of the grids the engine computes generations with, so a view cannot
+    // be updated. Copying into a view of the same size reuses its storage.
+    void               copy_view_to(Life &view) const;
+    [[nodiscard]] auto get_view() const -> Life;
+
+    [[nodiscard]] constexpr auto get_engine() const -> LifeEngine {
+        return this->engine;
+    }
+
+    [[nodiscard]] constexpr auto get_live_box() const -> LiveBox const & {
+        return this->live_box;
+    }
 
     [[nodiscard]] constexpr auto get_dimension() const -> u8 {
         return this->dimension;
     }
 
     [[nodiscard]] constexpr auto size() const -> u32 {
-        return static_cast<u32>(this->cells.size());
+        return static_cast<u32>(this->dimension) * this->dimension *
+               this->dimension;
     }
 
     [[nodiscard]] constexpr auto get_capacity() const -> usize {
@@ -64,6 +339,48 @@ class Life {
     [[nodiscard]] constexpr auto get_max_distance() const -> f32 {
         return this->max_distance;
     }
+
+    // empty with the Nibbles engine, whose cells only a view holds
+    [[nodiscard]] constexpr auto get_cells() const
+        -> std::span<CellState const> {
+        return this->cells;
+    }
+
+    // cells of a level of the pyramid, level 0 being the cells themselves,
+    // see get_cells
+    [[nodiscard]] constexpr auto get_level(u8 level) const
+        -> std::span<CellState const> {
+        if (level == 0) {
+            return this->cells;
+        }
+        return this->pyramid[level - 1];
+    }
+
+    [[nodiscard]] constexpr auto get_level_dimension(u8 level) const -> u8 {
+        return static_cast<u8>(
+            (this->dimension + (1U << level) - 1) >> level
+        );
+    }
+
+    [[nodiscard]] constexpr auto get_generation() const -> u64 {
+        return this->generation;
+    }
+
+    // whether advance stopped in the middle of a generation
+    [[nodiscard]] constexpr auto is_updating() const -> bool {
+        return this->next_slab != 0;
+    }
+
+    // number of chunks along each axis, the last one may be partial
+    [[nodiscard]] constexpr auto get_chunk_count() const -> u8 {
+        return this->chunk_count;
+    }
+
+    [[nodiscard]] constexpr auto get_chunk_stamp(u8 cx, u8 cy, u8 cz) const
+        -> u64 {
+        return this->chunk_stamps
+            [(((cz * this->chunk_count) + cy) * this->chunk_count) + cx];
+    }
 };
 
 } // namespace cell
@@ -0,0 +1,96 @@
+#ifndef CELLULAR_COUNTERS_H
+#define CELLULAR_COUNTERS_H
+
+#include <array>
+#include <string_view>
+
+#include <cell/alias.hpp>
+
+namespace cell {
+
+// see stats.hpp
+enum class Phase : u8;
+
+// Hardware events counted around the phases.
+enum class Counter : u8 {
+    Cycles,
+    Instructions,
+    CacheMisses,   // last level cache
+    StalledCycles, // cycles the backend could not issue in
+};
+
+static constexpr usize COUNTER_COUNT = 4;
+
+static constexpr std::array<std::string_view, COUNTER_COUNT> COUNTER_NAMES = {
+    "cycles", "instructions", "cache_misses", "stalled_cycles",
+};
+
+// Bytes brought in from memory by a cache miss.
+static constexpr u64 CACHE_LINE_SIZE = 64;
+
+// Events counted over some runs of a phase, summed over the threads that
+// ran it, and the cells those runs went through.
+class CounterSample {
+    std::array<u64, COUNTER_COUNT> counts{};
+    // bit i is set if the machine counts the counter i
+    u8                             counted{};
+    u64                            cells{};
+
+  public:
+    CounterSample() = default;
+    CounterSample(std::array<u64, COUNTER_COUNT> counts, u8 counted, u64 cells);
+
+    void merge(CounterSample const &other);
+
+    [[nodiscard]] constexpr auto has(Counter counter) const -> bool {
+        return (this->counted & (1U << static_cast<u8>(counter))) != 0;
+    }
+
+    [[nodiscard]] constexpr auto get(Counter counter) const -> u64 {
+        return this->counts[static_cast<usize>(counter)];
+    }
+
+    [[nodiscard]] constexpr auto get_cells() const -> u64 {
+        return this->cells;
+    }
+
+    // The following are 0 when their counters or the cells are missing.
+    [[nodiscard]] auto get_ipc() const -> f64;
+    [[nodiscard]] auto get_cycles_per_cell() const -> f64;
+    // traffic of the cache misses, an estimate of memory bandwidth
+    [[nodiscard]] auto get_bytes_per_cell() const -> f64;
+    // fraction of the cycles stalled
+    [[nodiscard]] auto get_stalled() const -> f64;
+};
+
+// Opens a group of perf_event_open counters on every thread that samples a
+// phase from now on. Prints the counters the machine supports, or why it
+// supports none, in which case sampling stays off and costs a load.
+void start_counters();
+[[nodiscard]] auto is_counting() -> bool;
+// Events of the phase sampled on every thread since the last call.
+[[nodiscard]] auto take_counters(Phase phase) -> CounterSample;
+
+// Counts the events of the calling thread from its construction to its
+// destruction into a phase that went through cells cells. A thread opens
+// its counters on its first scope, so a worker started per generation pays
+// a few system calls for each.
+class CounterScope {
+    Phase                          phase;
+    u64                            cells;
+    std::array<u64, COUNTER_COUNT> start{};
+    bool                           active;
+
+  public:
+    CounterScope(Phase phase, u64 cells);
+    ~CounterScope();
+
+    CounterScope(CounterScope const &)                     = delete;
+    CounterScope(CounterScope &&)                          = delete;
+    auto operator=(CounterScope const &) -> CounterScope & = delete;
+    auto operator=(CounterScope &&) -> CounterScope &      = delete;
+};
+
+} // namespace cell
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef CELLULAR_GOVERNOR_H
+#define CELLULAR_GOVERNOR_H
+
+#include <cell/alias.hpp>
+
+namespace cell {
+
+// Frames measured before each adjustment of the governor.
+static constexpr u32 GOVERNOR_INTERVAL = 30;
+
+// Bounds of the knobs of the governor.
+static constexpr f32 MIN_RENDER_SCALE      = 0.5F;
+static constexpr f32 RENDER_SCALE_STEP     = 0.1F;
+static constexpr f32 MAX_GOVERNOR_LOD_BIAS = 3.0F;
+static constexpr u8  MAX_THROTTLE          = 4;
+
+// Holds frames to a target time by trading quality for speed. Every
+// GOVERNOR_INTERVAL frames it compares the average CPU time of a frame,
+// preparing the draw and advancing the simulation, and its GPU time against
+// the target. A GPU bound frame is first drawn at a lower resolution, a CPU
+// bound one first gets fewer generations per second, so fewer chunks change
+// between frames, and both then fall back to coarser levels of detail. Once
+// frames are well under the target the knobs are restored in reverse.
+class Governor {
+    f64  target{};
+    bool enabled = true;
+
+    // the knobs, neutral when disabled
+    f32 render_scale = 1.0F;
+    f32 lod_bias{};
+    u8  throttle{};
+
+    // sums over the frames since the last adjustment
+    u32 frames{};
+    f64 draw_time{};
+    f64 update_time{};
+    u32 gpu_frames{};
+    f64 gpu_time{};
+    // seconds preparing the draw of a frame, over the last interval
+    f64 draw_average{};
+
+    void adjust();
+
+  public:
+    explicit Governor(f64 target);
+    Governor() = default;
+
+    // GPU seconds of a frame, as read back by GpuTimers some frames later.
+    void measure_gpu(f64 seconds);
+    // CPU seconds of the frame, spent preparing and issuing the draw and
+    // advancing the simulation on the render thread.
+    void measure(f64 draw_time, f64 update_time);
+
+    // Seconds a frame can spend on the simulation without missing the
+    // target, at most limit.
+    [[nodiscard]] auto get_update_budget(f64 limit) const -> f64;
+
+    void set_enabled(bool enabled);
+
+    [[nodiscard]] constexpr auto is_enabled() const -> bool {
+        return this->enabled;
+    }
+
+    // fraction of the window resolution frames are drawn at
+    [[nodiscard]] constexpr auto get_render_scale() const -> f32 {
+        return this->render_scale;
+    }
+
+    // added to the level of detail bias of the chunk renderer
+    [[nodiscard]] constexpr auto get_lod_bias() const -> f32 {
+        return this->lod_bias;
+    }
+
+    // halvings of the generation rate, see Simulation::set_throttle
+    [[nodiscard]] constexpr auto get_throttle() const -> u8 {
+        return this->throttle;
+    }
+};
+
+} // namespace cell
+
+#endif
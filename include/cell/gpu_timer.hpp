@@ -0,0 +1,82 @@
+#ifndef CELLULAR_GPU_TIMER_H
+#define CELLULAR_GPU_TIMER_H
+
+#include <array>
+#include <optional>
+
+#include <cell/alias.hpp>
+#include <cell/stats.hpp>
+
+namespace cell {
+
+// Frames in flight between GPU timer queries and reading them back.
+static constexpr usize GPU_QUERY_DEPTH = 4;
+
+// Spans a frame can time on top of the frame itself.
+static constexpr usize GPU_SPANS = 8;
+
+// Times frames, and spans of GPU phases within them, with GL_TIMESTAMP
+// queries, which unlike GL_TIME_ELAPSED ones may nest. The queries of a
+// frame are read back once the GPU has finished it, GPU_QUERY_DEPTH frames
+// later at most; a frame still unfinished by then is dropped rather than
+// waited for, so timing never stalls the CPU.
+class GpuTimers {
+    // the frame, then the spans, as begin and end pairs
+    static constexpr usize QUERIES = 2 * (GPU_SPANS + 1);
+
+    struct Frame {
+        std::array<GLuint, QUERIES>  queries{};
+        std::array<Phase, GPU_SPANS> phases{};
+        u8                           spans{};
+    };
+
+    std::array<Frame, GPU_QUERY_DEPTH> frames{};
+    u64                                issued{};
+    u64                                collected{};
+    // frames dropped because their queries were not ready in time
+    u64                                dropped{};
+    bool                               open{};
+
+    // Records the spans of the oldest frame in flight into stats, and
+    // returns its GPU seconds, if the GPU has finished it.
+    auto collect(Stats &stats) -> std::optional<f64>;
+
+  public:
+    // Reads back the frames the GPU has finished, recording their GPU time
+    // as Phase::Gpu and the sum of their spans of each phase into stats,
+    // then starts timing a frame. Returns the GPU seconds of the newest
+    // frame read back, if any.
+    auto begin_frame(Stats &stats) -> std::optional<f64>;
+    void end_frame();
+
+    // Starts a span of phase in the frame being timed, returning its index,
+    // or nothing if no frame is or it has no spans left.
+    auto begin(Phase phase) -> std::optional<u8>;
+    void end(u8 span);
+
+    [[nodiscard]] constexpr auto get_dropped() const -> u64 {
+        return this->dropped;
+    }
+
+    void destroy();
+};
+
+// Times the GL commands issued from its construction to its destruction as
+// a span of phase, if stats has GPU timers and they are timing a frame.
+class GpuZone {
+    GpuTimers         *timers;
+    std::optional<u8> span;
+
+  public:
+    GpuZone(Stats &stats, Phase phase);
+    ~GpuZone();
+
+    GpuZone(GpuZone const &)                     = delete;
+    GpuZone(GpuZone &&)                          = delete;
+    auto operator=(GpuZone const &) -> GpuZone & = delete;
+    auto operator=(GpuZone &&) -> GpuZone &      = delete;
+};
+
+} // namespace cell
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef CELLULAR_MEMORY_H
+#define CELLULAR_MEMORY_H
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include <cell/alias.hpp>
+
+namespace cell {
+
+// What the bytes of a MemoryAccount are for.
+enum class Memory : u8 {
+    Grid,        // cells, their pyramid and chunk stamps, in every copy
+    Scratch,     // the next generation and buffers of a single call
+    RenderCache, // meshes and images kept by the renderers
+    Gpu,         // buffers and textures handed to the driver
+};
+
+static constexpr usize MEMORY_COUNT = 4;
+
+static constexpr std::array<std::string_view, MEMORY_COUNT> MEMORY_NAMES = {
+    "grid", "scratch", "render_cache", "gpu",
+};
+
+// Bytes counted under a category, now and at most so far.
+struct MemoryUsage {
+    usize current;
+    usize peak;
+};
+
+// Counts some bytes under a category for as long as it lives. A copy counts
+// the same bytes again, so an object copied with its buffers, like the
+// snapshots of a Life, is counted once per copy.
+class MemoryAccount {
+    Memory category{};
+    usize  bytes{};
+
+  public:
+    explicit MemoryAccount(Memory category, usize bytes = 0);
+    MemoryAccount() = default;
+    ~MemoryAccount();
+
+    MemoryAccount(MemoryAccount const &other);
+    MemoryAccount(MemoryAccount &&other) noexcept;
+    auto operator=(MemoryAccount const &other) -> MemoryAccount &;
+    auto operator=(MemoryAccount &&other) noexcept -> MemoryAccount &;
+
+    // Counts bytes instead of what was counted before.
+    void set(usize bytes);
+
+    [[nodiscard]] constexpr auto get_bytes() const -> usize {
+        return this->bytes;
+    }
+};
+
+[[nodiscard]] auto get_memory(Memory category) -> MemoryUsage;
+// over every category, the peak being that of the sum
+[[nodiscard]] auto get_total_memory() -> MemoryUsage;
+// bytes as a number of MiB
+[[nodiscard]] auto format_bytes(usize bytes) -> std::string;
+// Prints the current and peak bytes of every category.
+void print_memory();
+
+} // namespace cell
+
+#endif
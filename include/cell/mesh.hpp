@@ -0,0 +1,90 @@
+#ifndef CELLULAR_MESH_H
+#define CELLULAR_MESH_H
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+#include <cell/alias.hpp>
+#include <cell/cell.hpp>
+#include <cell/memory.hpp>
+#include <glm/vec3.hpp>
+
+namespace cell {
+
+// Faces of a cell, in the order of FACE_CORNERS in shader/chunk.vert.
+enum class Side : u8 {
+    NegX,
+    PosX,
+    NegY,
+    PosY,
+    NegZ,
+    PosZ,
+};
+
+// Face record read by shader/chunk.vert: x, y and z one byte each, then 3 bits
+// of side and 5 bits of state.
+[[nodiscard]] constexpr auto
+pack_face(u8 x, u8 y, u8 z, Side side, CellState state) -> u32 {
+    return static_cast<u32>(x) | (static_cast<u32>(y) << 8U) |
+           (static_cast<u32>(z) << 16U) | (static_cast<u32>(side) << 24U) |
+           (static_cast<u32>(std::min<CellState>(state, 31)) << 27U);
+}
+
+struct ChunkFaces {
+    std::vector<u32> faces;
+    // bounds of the cells with faces, in cell coordinates
+    glm::vec3        lower{};
+    glm::vec3        upper{};
+    // generation of the Life the faces were built from
+    u64              stamp{};
+    // level of the Life pyramid the faces were built from
+    u8               level{};
+    // every cell of the chunk is alive
+    bool             solid{};
+};
+
+// Surface mesh of a Life split in CHUNK_SIZE^3 chunks. Only faces between a
+// live cell and a dead one, or the outside of the world, are kept, and a
+// chunk is only rebuilt when it or one of its neighbours changed, or when it
+// is asked for at another level of the Life pyramid. Face positions are in
+// cells of the level the chunk was built from.
+class ChunkMesh {
+    std::vector<ChunkFaces> chunks;
+    u8                      dimension{};
+    u8                      chunk_count{};
+    MemoryAccount           memory{Memory::RenderCache};
+
+    [[nodiscard]] constexpr auto idx(u32 cx, u32 cy, u32 cz) const -> u32 {
+        return (((cz * this->chunk_count) + cy) * this->chunk_count) + cx;
+    }
+
+    [[nodiscard]] auto is_dirty(Life const &life, u8 cx, u8 cy, u8 cz) const
+        -> bool;
+    [[nodiscard]] auto is_solid(Life const &life, u32 chunk) const -> bool;
+    void build(Life const &life, u32 chunk, u8 level);
+
+  public:
+    // Rebuilds, in parallel, the chunks that changed or whose level in
+    // levels changed, and returns their indices.
+    auto update(Life const &life, std::span<u8 const> levels)
+        -> std::vector<u32>;
+
+    // Whether the chunk is hidden from the eye, in cell coordinates, behind
+    // solid neighbours on every side that faces it.
+    [[nodiscard]] auto is_occluded(u32 chunk, glm::vec3 const &eye) const
+        -> bool;
+
+    [[nodiscard]] constexpr auto get_chunks() const
+        -> std::span<ChunkFaces const> {
+        return this->chunks;
+    }
+
+    [[nodiscard]] constexpr auto get_chunk_count() const -> u8 {
+        return this->chunk_count;
+    }
+};
+
+} // namespace cell
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef CELLULAR_METRICS_H
+#define CELLULAR_METRICS_H
+
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <cell/alias.hpp>
+#include <cell/cell.hpp>
+#include <cell/simulation.hpp>
+#include <cell/stats.hpp>
+
+namespace cell {
+
+// Milliseconds the server waits for a connection before checking whether
+// it should stop.
+static constexpr i32 METRICS_POLL_TIMEOUT = 100;
+
+// Serves the metrics of a run in the Prometheus text format, over HTTP on
+// a port of localhost or on a Unix socket. The thread running the frames
+// formats them once per STATS_INTERVAL and swaps them in, and the server
+// answers every request with the newest, so a scrape never touches the
+// simulation or waits for it.
+class MetricsServer {
+    TripleBuffer<std::string> snapshots;
+    i32                       socket = -1;
+    // a port, or the path of the Unix socket
+    std::string               address;
+
+    // owned by the thread calling publish, as of its last call
+    f64 last_time{};
+    u64 last_generation{};
+    f64 last_cpu_time{};
+
+    std::jthread thread;
+
+    void serve(std::stop_token const &stop);
+
+  public:
+    // Listens on 127.0.0.1 if address is a port number, or else on a Unix
+    // socket at the path address, panicking if it cannot.
+    explicit MetricsServer(std::string_view address);
+    ~MetricsServer();
+
+    MetricsServer(MetricsServer const &)                     = delete;
+    MetricsServer(MetricsServer &&)                          = delete;
+    auto operator=(MetricsServer const &) -> MetricsServer & = delete;
+    auto operator=(MetricsServer &&) -> MetricsServer &      = delete;
+
+    // Formats the recent latencies of stats and the state of life, time
+    // seconds into the run, for the next scrapes.
+    void publish(Stats const &stats, Life const &life, f64 time);
+};
+
+} // namespace cell
+
+#endif
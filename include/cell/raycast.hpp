@@ -0,0 +1,48 @@
+#ifndef CELLULAR_RAYCAST_H
+#define CELLULAR_RAYCAST_H
+
+#include <filesystem>
+#include <vector>
+
+#include <cell/alias.hpp>
+#include <cell/cell.hpp>
+#include <cell/memory.hpp>
+#include <cell/render.hpp>
+
+namespace cell {
+
+// RGB image, one byte per channel, rows from top to bottom.
+struct Image {
+    u32             width{};
+    u32             height{};
+    std::vector<u8> pixels;
+};
+
+// Writes image as a binary PPM file.
+void write_ppm(Image const &image, std::filesystem::path const &path);
+
+// Renders a Life without a GPU, casting a ray per pixel through the cells
+// and jumping over the blocks the Life pyramid marks as empty, the same way
+// as shader/volume.frag. The image is split into tiles shared by
+// THREAD_COUNT threads.
+class Raycaster {
+    Image         image;
+    MemoryAccount memory;
+
+    void draw_tile(
+        Life const      &life,
+        CellColor const &color,
+        glm::mat4 const &inverse,
+        u32              tile
+    );
+
+  public:
+    Raycaster(u32 width, u32 height);
+
+    auto draw(Life const &life, CellColor const &color, Camera const &camera)
+        -> Image const &;
+};
+
+} // namespace cell
+
+#endif
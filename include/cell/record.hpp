@@ -0,0 +1,89 @@
+#ifndef CELLULAR_RECORD_H
+#define CELLULAR_RECORD_H
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <cell/alias.hpp>
+#include <cell/memory.hpp>
+#include <cell/raycast.hpp>
+
+namespace cell {
+
+// Frames per second of recorded videos, one generation per frame.
+static constexpr u32 RECORD_FRAME_RATE = 30;
+
+// Frames in flight between glReadPixels and the CPU reading them.
+static constexpr usize READBACK_DEPTH = 3;
+
+// Reads frames back from the bound framebuffer through a ring of pixel
+// buffer objects. glReadPixels into a buffer returns at once, and a buffer
+// is only mapped READBACK_DEPTH frames later, when the GPU is long done
+// with it, so reading never waits for the frame being drawn.
+class FrameReader {
+    std::array<GLuint, READBACK_DEPTH> buffers{};
+    u32                                width{};
+    u32                                height{};
+    MemoryAccount                      gpu_memory{Memory::Gpu};
+    // frames handed to glReadPixels and frames mapped back
+    u64                                issued{};
+    u64                                collected{};
+
+    auto collect() -> Image;
+
+  public:
+    FrameReader(u32 width, u32 height);
+    FrameReader() = default;
+
+    // Starts reading the bound framebuffer, and returns the frame read
+    // READBACK_DEPTH frames ago once the ring is full.
+    auto read() -> std::optional<Image>;
+    // Frames still in flight, oldest first.
+    auto flush() -> std::vector<Image>;
+    void destroy();
+};
+
+// Writes frames on background threads, either as numbered PPM files in a
+// directory or, when the output ends in .y4m, as one raw YUV 4:2:0 stream.
+// push blocks while THREAD_COUNT frames are already waiting.
+class FrameEncoder {
+    std::filesystem::path             output;
+    u32                               width;
+    u32                               height;
+    bool                              y4m;
+    std::ofstream                     stream;
+    std::mutex                        mutex;
+    std::condition_variable           changed;
+    std::deque<std::pair<u64, Image>> queue;
+    u64                               pushed{};
+    // next frame to append to the y4m stream, which must stay in order
+    u64                               written{};
+    bool                              done{};
+    std::vector<std::jthread>         threads;
+
+    void work();
+    void encode(u64 index, Image const &image);
+
+  public:
+    FrameEncoder(std::filesystem::path output, u32 width, u32 height);
+    ~FrameEncoder();
+
+    FrameEncoder(FrameEncoder const &)                     = delete;
+    FrameEncoder(FrameEncoder &&)                          = delete;
+    auto operator=(FrameEncoder const &) -> FrameEncoder & = delete;
+    auto operator=(FrameEncoder &&) -> FrameEncoder &      = delete;
+
+    void push(Image image);
+};
+
+} // namespace cell
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef CELLULAR_RENDER_H
+#define CELLULAR_RENDER_H
+
+#include <span>
+#include <vector>
+
+#include <cell/alias.hpp>
+#include <cell/cell.hpp>
+#include <cell/memory.hpp>
+#include <cell/mesh.hpp>
+#include <cell/shader.hpp>
+#include <cell/stats.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+namespace cell {
+
+struct Camera {
+    // from cell coordinates to clip space
+    glm::mat4 mvp;
+    // position of the eye in cell coordinates
+    glm::vec3 eye;
+    // size of the framebuffer in pixels
+    glm::vec2 viewport;
+    // pixels covered by one cell at a distance of one cell
+    f32       pixel_scale;
+};
+
+// Locations of the uniforms read by the shader-side cell colouring.
+struct ColorUniforms {
+    GLint gradient;
+    GLint palette;
+    GLint from;
+    GLint to;
+    GLint max_distance;
+    GLint dimension;
+
+    explicit ColorUniforms(Shader const &shader);
+    ColorUniforms() = default;
+
+    void set(CellColor const &color, Life const &life) const;
+};
+
+// Draws every live cell as an instance of a unit cube, from the records of
+// Life::draw.
+class CubeRenderer {
+    Shader        program;
+    GLuint        VAO{};
+    GLuint        cell_buffer{};
+    GLint         mvp_location{};
+    GLint         vertex_cell{};
+    ColorUniforms color_uniforms;
+    MemoryAccount gpu_memory{Memory::Gpu};
+
+  public:
+    explicit CubeRenderer(Shader program);
+    CubeRenderer() = default;
+
+    void draw(
+        Life const      &life,
+        CellColor const &color,
+        Camera const    &camera,
+        Stats           &stats
+    );
+    void destroy();
+};
+
+// Draws every live cell as a single point, from the records of Life::draw.
+// The point is sized to cover the cell's cube on screen, and
+// shader/point.frag intersects the fragment's ray with the cube to keep
+// only the cube's pixels and write their depth.
+class PointRenderer {
+    Shader        program;
+    GLuint        VAO{};
+    GLuint        cell_buffer{};
+    GLint         mvp_location{};
+    GLint         inverse_location{};
+    GLint         viewport_location{};
+    GLint         pixel_scale_location{};
+    GLint         vertex_cell{};
+    ColorUniforms color_uniforms;
+    MemoryAccount gpu_memory{Memory::Gpu};
+
+  public:
+    explicit PointRenderer(Shader program);
+    PointRenderer() = default;
+
+    void draw(
+        Life const      &life,
+        CellColor const &color,
+        Camera const    &camera,
+        Stats           &stats
+    );
+    void destroy();
+};
+
+// Draws the exposed faces of a ChunkMesh. Every chunk owns a range of one
+// face buffer, read by shader/chunk.vert through a buffer texture. Chunks
+// outside the view frustum or occluded by solid neighbours are skipped, and
+// the rest are drawn front to back by one glMultiDrawArrays call per level
+// of detail. A chunk is meshed from the coarsest level of the Life pyramid
+// whose cells still project to about a pixel, shifted by lod_bias.
+class ChunkRenderer {
+    ChunkMesh        mesh;
+    Shader           program;
+    GLuint           VAO{};
+    GLuint           face_buffer{};
+    GLuint           face_texture{};
+    GLint            mvp_location{};
+    GLint            faces_location{};
+    GLint            level_location{};
+    ColorUniforms    color_uniforms;
+    f32              lod_bias{};
+    // first face and capacity of each chunk in face_buffer
+    std::vector<u32> offsets;
+    std::vector<u32> capacities;
+    MemoryAccount    gpu_memory{Memory::Gpu};
+
+    void upload(std::span<u32 const> rebuilt);
+    void relayout();
+
+  public:
+    explicit ChunkRenderer(Shader program);
+    ChunkRenderer() = default;
+
+    void draw(
+        Life const      &life,
+        CellColor const &color,
+        Camera const    &camera,
+        Stats           &stats
+    );
+    void destroy();
+
+    [[nodiscard]] constexpr auto get_lod_bias() const -> f32 {
+        return this->lod_bias;
+    }
+
+    constexpr void set_lod_bias(f32 bias) {
+        this->lod_bias = bias;
+    }
+};
+
+// Ray-marches the cells in shader/volume.frag from a 3D texture of their
+// states, so the cost of a frame depends on the screen and not on the
+// population. Mip level n of the texture is level n of the Life pyramid and
+// lets the march jump over empty blocks. The texture is padded to whole
+// chunks so every level fits its mip exactly, and only the chunks changed
+// since the last draw are uploaded.
+class VolumeRenderer {
+    Shader        program;
+    GLuint        VAO{};
+    GLuint        cell_texture{};
+    GLint         mvp_location{};
+    GLint         inverse_location{};
+    GLint         cells_location{};
+    ColorUniforms color_uniforms;
+    // dimension and generation of the Life in cell_texture
+    u8            dimension{};
+    u64           stamp{};
+    MemoryAccount gpu_memory{Memory::Gpu};
+
+    void upload(Life const &life);
+
+  public:
+    explicit VolumeRenderer(Shader program);
+    VolumeRenderer() = default;
+
+    void draw(
+        Life const      &life,
+        CellColor const &color,
+        Camera const    &camera,
+        Stats           &stats
+    );
+    void destroy();
+};
+
+// Colour and depth buffers a frame is drawn to at a fraction of the window
+// resolution, then stretched over the window.
+class ScaledTarget {
+    GLuint        framebuffer{};
+    GLuint        color{};
+    GLuint        depth{};
+    glm::ivec2    size{};
+    MemoryAccount gpu_memory{Memory::Gpu};
+
+  public:
+    // Binds the framebuffer, reallocated at scale times the window size when
+    // that changes, and sets the viewport to it. Returns its size.
+    auto bind(glm::ivec2 window, f32 scale) -> glm::ivec2;
+    // Stretches the frame over the default framebuffer and binds it.
+    void resolve(glm::ivec2 window) const;
+    void destroy();
+};
+
+} // namespace cell
+
+#endif
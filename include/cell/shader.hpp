@@ -2,24 +2,48 @@
 #define CELLULAR_SHADER_H
 
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 
 #include <cell/alias.hpp>
 #include <glm/mat4x4.hpp>
 
 namespace cell {
 
+// A file of shader/, embedded in the binary at build time.
+struct ShaderSource {
+    std::string_view name;
+    std::string_view code;
+};
+
+// every file of shader/, generated by the Makefile into obj/shaders.cpp
+extern std::span<ShaderSource const> const SHADER_SOURCES;
+
+// Lets the driver compile shaders on its own threads, when it supports
+// KHR_parallel_shader_compile.
+void enable_parallel_compile();
+
+// A program linked from two files of SHADER_SOURCES. The constructor only
+// issues the compile and link, or loads the program from the binary cache,
+// so the driver can build several programs at once; wait must be called
+// before the program is used.
 class Shader {
     u32 id{};
+    // shaders being compiled, 0 once linked or loaded from the cache
+    u32 vertex{};
+    u32 fragment{};
+    // hash of the driver and the sources, naming the cached binary
+    u64 key{};
 
   public:
-    Shader(
-        char const *vertex_path,
-        char const *geom_path,
-        char const *fragment_path
-    );
+    Shader(std::string_view vertex_name, std::string_view fragment_name);
     Shader() = default;
 
+    // Waits for the program to link, panicking on errors, and caches the
+    // binary of a program that was not loaded from the cache.
+    void wait();
+
     [[nodiscard]] auto get_id() const -> u32;
     void               use() const;
 
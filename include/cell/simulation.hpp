@@ -0,0 +1,158 @@
+#ifndef CELLULAR_SIMULATION_H
+#define CELLULAR_SIMULATION_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+
+#include <cell/alias.hpp>
+#include <cell/cell.hpp>
+#include <cell/stats.hpp>
+
+namespace cell {
+
+// Highest target of Simulation::set_rate, in generations per second.
+static constexpr u32 MAX_GENERATION_RATE = 1024;
+
+// Hands values from one writer thread to one reader thread without locks.
+// The writer fills the back slot and swaps it with the middle one, and the
+// reader swaps the middle slot with its front one whenever the middle holds
+// a newer value, so neither ever waits for the other and the reader always
+// gets the newest complete value.
+template <typename T> class TripleBuffer {
+    // index of the middle slot, and whether the writer published into it
+    // since the reader last took it
+    static constexpr u8 INDEX = 0b011;
+    static constexpr u8 FRESH = 0b100;
+
+    std::array<T, 3> slots;
+    std::atomic<u8>  middle{1};
+    // owned by the writer and the reader respectively
+    u8               back{0};
+    u8               front{2};
+
+  public:
+    explicit TripleBuffer(T const &value) : slots{value, value, value} {}
+
+    // slot the writer fills before calling publish
+    [[nodiscard]] auto get_back() -> T & {
+        return this->slots[this->back];
+    }
+
+    void publish() {
+        this->back = this->middle.exchange(
+                         this->back | FRESH, std::memory_order_acq_rel
+                     ) &
+                     INDEX;
+    }
+
+    // Newest published value, valid until the next call to read.
+    [[nodiscard]] auto read() -> T const & {
+        if ((this->middle.load(std::memory_order_relaxed) & FRESH) != 0) {
+            this->front =
+                this->middle.exchange(this->front, std::memory_order_acq_rel) &
+                INDEX;
+        }
+        return this->slots[this->front];
+    }
+};
+
+// Seeds life for rule, over the whole world if full_init is set, or else
+// in a small cube at its centre.
+void init_life(Life &life, LifeRule const &rule, bool full_init);
+
+// Runs Life on a thread of its own, or in slices of the frames of a machine
+// that cannot spare one, at a target rate of generations per second or as
+// fast as it can, and publishes a view of the world after each generation,
+// see Life::copy_view_to.
+// The renderer reads the newest copy without ever waiting for a generation
+// to finish, and changes of rule or size are only applied between two
+// generations.
+class Simulation {
+    TripleBuffer<Life>          snapshots;
+    // world being updated, owned by the thread running the generations
+    Life                        life;
+    std::mutex                  mutex;
+    std::condition_variable_any changed;
+
+    // guarded by mutex
+    LifeRule  rule;
+    u8        dimension;
+    bool      full_init;
+    // restart the world before the next generation
+    bool      pending = true;
+    // generations per second, 0 for as fast as possible
+    u32       rate    = 15;
+    // halvings of rate asked for by the governor
+    u8        throttle{};
+    // generations since take_updates was last called
+    Histogram updates;
+
+    // owned by the thread calling advance
+    std::chrono::steady_clock::time_point due;
+    // time spent on the generation advance is in the middle of
+    std::chrono::nanoseconds              slice_time{};
+
+    std::jthread thread;
+
+    void run(std::stop_token const &stop);
+    // Restarts the world and publishes it if asked to, or else returns the
+    // rule of the next generation.
+    auto apply_pending() -> std::optional<LifeRule>;
+    void publish();
+    void add_update(std::chrono::nanoseconds duration);
+    // rate after the throttle, with the lock held
+    [[nodiscard]] auto throttled_rate() const -> u32;
+
+  public:
+    Simulation(u8 dimension, LifeRule rule, bool full_init);
+    ~Simulation() = default;
+
+    Simulation(Simulation const &)                     = delete;
+    Simulation(Simulation &&)                          = delete;
+    auto operator=(Simulation const &) -> Simulation & = delete;
+    auto operator=(Simulation &&) -> Simulation &      = delete;
+
+    // Bytes of the world and the views published of it, at dimension with a
+    // rule of state_count states.
+    [[nodiscard]] static auto estimate_memory(u8 dimension, u8 state_count)
+        -> LifeMemory;
+
+    // Runs generations on the simulation thread until destruction.
+    void start();
+    // Runs one generation on the calling thread, for a simulation that was
+    // never started.
+    void step();
+    // Spends about budget seconds of the calling thread on generations, a
+    // slab at a time, for a simulation that was never started. A frame
+    // calling it never waits for a whole generation.
+    void advance(f64 budget);
+
+    // View of the newest published world, valid until the next call to
+    // read. Only one thread may read.
+    [[nodiscard]] auto read() -> Life const &;
+
+    // The following restart the world before the next generation.
+    void set_rule(LifeRule const &rule, bool full_init);
+    void resize(u8 dimension);
+    void restart();
+
+    void               set_rate(u32 rate);
+    [[nodiscard]] auto get_rate() -> u32;
+    // Halves the rate throttle times, capping an unlimited rate at
+    // MAX_GENERATION_RATE first.
+    void               set_throttle(u8 throttle);
+    // size of the world once pending changes are applied
+    [[nodiscard]] auto get_dimension() -> u8;
+    // Durations of the generations since the last call.
+    [[nodiscard]] auto take_updates() -> Histogram;
+};
+
+} // namespace cell
+
+#endif
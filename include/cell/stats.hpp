@@ -0,0 +1,207 @@
+#ifndef CELLULAR_STATS_H
+#define CELLULAR_STATS_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+#include <cell/alias.hpp>
+#include <cell/counters.hpp>
+#include <cell/trace.hpp>
+
+namespace cell {
+
+class GpuTimers;
+
+// Timed phases of a generation or a frame.
+enum class Phase : u8 {
+    Update,     // one generation of Life
+    Compaction, // packing cells or meshing chunks for a renderer
+    Upload,     // handing cells, faces or textures to the GPU
+    Draw,       // everything a frame does on the CPU, uploads included
+    Gpu,        // GPU time of a frame
+    GpuUpload,  // GPU time of the uploads of a frame
+    GpuDraw,    // GPU time of the draw calls of a frame
+    Swap,       // glfwSwapBuffers
+};
+
+static constexpr usize PHASE_COUNT = 8;
+
+static constexpr std::array<std::string_view, PHASE_COUNT> PHASE_NAMES = {
+    "update", "compaction", "upload",   "draw",
+    "gpu",    "gpu_upload", "gpu_draw", "swap",
+};
+
+// Counts of durations in nanoseconds, in the manner of HdrHistogram. Values
+// below 2^SUB_BUCKET_BITS get a bucket each, and every larger power of two
+// is split into 2^SUB_BUCKET_BITS buckets, so a bucket is never wider than
+// about 3% of its values and recording is a bit scan and an increment.
+class Histogram {
+    static constexpr u32 SUB_BUCKET_BITS = 5;
+    static constexpr u32 SUB_BUCKETS     = 1U << SUB_BUCKET_BITS;
+    static constexpr u32 BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    std::array<u64, BUCKETS> counts{};
+    u64                      count{};
+    u64                      sum{};
+    u64                      max{};
+
+    [[nodiscard]] static constexpr auto bucket(u64 value) -> u32 {
+        auto const width = static_cast<u32>(std::bit_width(value));
+        if (width <= SUB_BUCKET_BITS) {
+            return static_cast<u32>(value);
+        }
+        // the top SUB_BUCKET_BITS + 1 bits, which start with a 1
+        u32 const shift = width - SUB_BUCKET_BITS - 1;
+        return (shift * SUB_BUCKETS) + static_cast<u32>(value >> shift);
+    }
+
+    // largest value counted in a bucket
+    [[nodiscard]] static constexpr auto highest(u32 bucket) -> u64 {
+        if (bucket < SUB_BUCKETS) {
+            return bucket;
+        }
+        u32 const shift = (bucket / SUB_BUCKETS) - 1;
+        u64 const top   = (bucket % SUB_BUCKETS) + SUB_BUCKETS;
+        return ((top + 1) << shift) - 1;
+    }
+
+  public:
+    constexpr void record(u64 nanoseconds) {
+        this->counts[bucket(nanoseconds)] += 1;
+        this->count += 1;
+        this->sum += nanoseconds;
+        this->max = std::max(this->max, nanoseconds);
+    }
+
+    void merge(Histogram const &other);
+    void clear();
+
+    // smallest value at least a fraction of the values are not above
+    [[nodiscard]] auto percentile(f64 fraction) const -> u64;
+
+    [[nodiscard]] constexpr auto get_count() const -> u64 {
+        return this->count;
+    }
+
+    [[nodiscard]] constexpr auto get_max() const -> u64 {
+        return this->max;
+    }
+
+    [[nodiscard]] constexpr auto get_mean() const -> f64 {
+        if (this->count == 0) {
+            return 0.0;
+        }
+        return static_cast<f64>(this->sum) / static_cast<f64>(this->count);
+    }
+};
+
+// Latencies of every phase since the last flush, and over the whole run,
+// with the hardware events counted in them when counting.
+class Stats {
+    std::array<Histogram, PHASE_COUNT>     recent;
+    std::array<Histogram, PHASE_COUNT>     total;
+    std::array<CounterSample, PHASE_COUNT> recent_counters;
+    std::array<CounterSample, PHASE_COUNT> total_counters;
+    // times the spans of GpuZones, if set
+    GpuTimers                             *gpu_timers{};
+
+  public:
+    void record(Phase phase, std::chrono::nanoseconds duration) {
+        this->recent[static_cast<usize>(phase)].record(
+            static_cast<u64>(duration.count())
+        );
+    }
+
+    void record(Phase phase, f64 seconds) {
+        this->recent[static_cast<usize>(phase)].record(
+            static_cast<u64>(seconds * 1e9)
+        );
+    }
+
+    void merge(Phase phase, Histogram const &histogram);
+    // Adds the events counted on every thread since the last call to the
+    // recent ones, see take_counters.
+    void take_counters();
+    // Moves the recent latencies and events into the totals.
+    void flush();
+
+    [[nodiscard]] auto get_recent(Phase phase) const -> Histogram const & {
+        return this->recent[static_cast<usize>(phase)];
+    }
+
+    [[nodiscard]] auto get_total(Phase phase) const -> Histogram const & {
+        return this->total[static_cast<usize>(phase)];
+    }
+
+    [[nodiscard]] auto get_recent_counters(Phase phase) const
+        -> CounterSample const & {
+        return this->recent_counters[static_cast<usize>(phase)];
+    }
+
+    // Times the GpuZones opened on stats with timers, which outlive them.
+    void set_gpu_timers(GpuTimers *timers) {
+        this->gpu_timers = timers;
+    }
+
+    [[nodiscard]] constexpr auto get_gpu_timers() const -> GpuTimers * {
+        return this->gpu_timers;
+    }
+
+    // Prints the totals of the phases that were timed at all.
+    void print() const;
+};
+
+// Records the time from its construction to its destruction into a phase,
+// as a trace zone named after it, and the events counted in it over cells
+// cells.
+class PhaseTimer {
+    Stats                                &stats;
+    Phase                                 phase;
+    std::chrono::steady_clock::time_point start;
+    TraceZone                             zone;
+    CounterScope                          counters;
+
+  public:
+    PhaseTimer(Stats &stats, Phase phase, u64 cells = 0)
+        : stats(stats), phase(phase), start(std::chrono::steady_clock::now()),
+          zone(PHASE_NAMES[static_cast<usize>(phase)]),
+          counters(phase, cells) {}
+
+    ~PhaseTimer() {
+        this->stats.record(
+            this->phase, std::chrono::steady_clock::now() - this->start
+        );
+    }
+
+    PhaseTimer(PhaseTimer const &)                     = delete;
+    PhaseTimer(PhaseTimer &&)                          = delete;
+    auto operator=(PhaseTimer const &) -> PhaseTimer & = delete;
+    auto operator=(PhaseTimer &&) -> PhaseTimer &      = delete;
+};
+
+// Seconds between two writes of a StatsWriter.
+static constexpr f64 STATS_INTERVAL = 1.0;
+
+// Appends the recent latencies of Stats to a file, as one JSON object per
+// line, or as CSV rows of one phase each when the path ends in .csv.
+// Durations are in milliseconds, and the metrics of the events counted, if
+// any, follow them.
+class StatsWriter {
+    std::ofstream stream;
+    bool          csv;
+
+  public:
+    explicit StatsWriter(std::filesystem::path const &path);
+
+    // Writes the recent latencies, time seconds into the run.
+    void write(Stats const &stats, f64 time, u64 generation);
+};
+
+} // namespace cell
+
+#endif
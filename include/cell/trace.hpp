@@ -0,0 +1,45 @@
+#ifndef CELLULAR_TRACE_H
+#define CELLULAR_TRACE_H
+
+#include <filesystem>
+#include <string_view>
+
+#include <cell/alias.hpp>
+
+namespace cell {
+
+// Zones each thread keeps before overwriting its oldest.
+static constexpr usize TRACE_CAPACITY = 1 << 14;
+
+// Starts recording zones, to be dumped to path. Until then a zone costs an
+// atomic load.
+void start_tracing(std::filesystem::path const &path);
+[[nodiscard]] auto is_tracing() -> bool;
+// Names the calling thread in the dump. The rings of threads that exit are
+// reused by the next ones, so short-lived workers share a few rows.
+void set_trace_thread_name(std::string_view name);
+// Writes the zones of every ring to the path given to start_tracing in
+// Chrome trace-event JSON, for chrome://tracing or Perfetto. Does nothing
+// unless tracing.
+void dump_trace();
+
+// Records the time from its construction to its destruction as a zone of
+// the calling thread, if tracing. name must outlive the dump.
+class TraceZone {
+    std::string_view name;
+    // -1 if tracing was off
+    i64              start;
+
+  public:
+    explicit TraceZone(std::string_view name);
+    ~TraceZone();
+
+    TraceZone(TraceZone const &)                     = delete;
+    TraceZone(TraceZone &&)                          = delete;
+    auto operator=(TraceZone const &) -> TraceZone & = delete;
+    auto operator=(TraceZone &&) -> TraceZone &      = delete;
+};
+
+} // namespace cell
+
+#endif
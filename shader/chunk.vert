@@ -0,0 +1,41 @@
+#version 420 core
+#include "color.glsl"
+
+out vec3 fragment_color;
+
+uniform mat4 MVP;
+uniform usamplerBuffer faces;
+// level of the Life pyramid the faces were built from
+uniform uint level;
+
+// corners of each face, counter-clockwise seen from outside the cube, in
+// the order of Side in include/cell/mesh.hpp
+const vec3 FACE_CORNERS[24] = {
+    vec3(-0.5, -0.5, -0.5), vec3(-0.5, -0.5, +0.5), vec3(-0.5, +0.5, +0.5), vec3(-0.5, +0.5, -0.5), // -x
+    vec3(+0.5, -0.5, -0.5), vec3(+0.5, +0.5, -0.5), vec3(+0.5, +0.5, +0.5), vec3(+0.5, -0.5, +0.5), // +x
+    vec3(-0.5, -0.5, -0.5), vec3(+0.5, -0.5, -0.5), vec3(+0.5, -0.5, +0.5), vec3(-0.5, -0.5, +0.5), // -y
+    vec3(-0.5, +0.5, -0.5), vec3(-0.5, +0.5, +0.5), vec3(+0.5, +0.5, +0.5), vec3(+0.5, +0.5, -0.5), // +y
+    vec3(-0.5, -0.5, -0.5), vec3(-0.5, +0.5, -0.5), vec3(+0.5, +0.5, -0.5), vec3(+0.5, -0.5, -0.5), // -z
+    vec3(-0.5, -0.5, +0.5), vec3(+0.5, -0.5, +0.5), vec3(+0.5, +0.5, +0.5), vec3(-0.5, +0.5, +0.5) // +z
+};
+
+// two triangles per face
+const uint QUAD[6] = {0, 1, 2, 0, 2, 3};
+
+void main() {
+    // x, y, z one byte each, then 3 bits of side and 5 of state, see pack_face
+    uint face = texelFetch(faces, gl_VertexID / 6).r;
+    vec3 position = vec3(face & 0xFFu, (face >> 8) & 0xFFu, (face >> 16) & 0xFFu);
+    uint side = (face >> 24) & 0x7u;
+
+    // a cell of the level covers scale^3 cells
+    float scale = float(1u << level);
+    position = position * scale + (scale - 1.0) * 0.5;
+
+    fragment_color = cell_color(face >> 27, position);
+
+    // the last cells of a coarse level may reach past the world
+    vec3 corner = position + FACE_CORNERS[side * 4 + QUAD[gl_VertexID % 6]] * scale;
+    corner = min(corner, float(dimension) - 0.5);
+    gl_Position = MVP * vec4(corner, 1.0);
+}
@@ -0,0 +1,27 @@
+// see CellColor in include/cell/cell.hpp
+const uint GRADIENT_STATE = 0;
+const uint GRADIENT_DISTANCE = 1;
+const uint GRADIENT_DISTANCE_SQRT = 2;
+const uint GRADIENT_POSITION = 3;
+
+uniform uint gradient;
+uniform vec3 palette[16];
+uniform vec3 gradient_from;
+uniform vec3 gradient_to;
+uniform float max_distance;
+uniform uint dimension;
+
+vec3 cell_color(uint state, vec3 position) {
+    vec3 from_center = position - float(dimension >> 1);
+    float distance = dot(from_center, from_center) / max_distance;
+    switch (gradient) {
+        case GRADIENT_DISTANCE:
+            return mix(gradient_from, gradient_to, distance);
+        case GRADIENT_DISTANCE_SQRT:
+            return mix(gradient_from, gradient_to, sqrt(distance));
+        case GRADIENT_POSITION:
+            return position / float(dimension);
+        default:
+            return palette[min(state, 15u)];
+    }
+}
@@ -0,0 +1,32 @@
+#version 420 core
+#include "color.glsl"
+
+in uint cell;
+
+out vec3 fragment_color;
+
+uniform mat4 MVP;
+
+const vec3 CUBE_STRIP[14] = {
+    vec3(+0.5, +0.5, -0.5), // Back-top-right
+    vec3(-0.5, +0.5, -0.5), // Back-top-left
+    vec3(+0.5, -0.5, -0.5), // Back-bottom-right
+    vec3(-0.5, -0.5, -0.5), // Back-bottom-left
+    vec3(-0.5, -0.5, +0.5), // Front-bottom-left
+    vec3(-0.5, +0.5, -0.5), // Back-top-left
+    vec3(-0.5, +0.5, +0.5), // Front-top-left
+    vec3(+0.5, +0.5, -0.5), // Back-top-right
+    vec3(+0.5, +0.5, +0.5), // Front-top-right
+    vec3(+0.5, -0.5, -0.5), // Back-bottom-right
+    vec3(+0.5, -0.5, +0.5), // Front-bottom-right
+    vec3(-0.5, -0.5, +0.5), // Front-bottom-left
+    vec3(+0.5, +0.5, +0.5), // Front-top-right
+    vec3(-0.5, +0.5, +0.5) // Front-top-left
+};
+
+void main() {
+    // x, y, z and state packed one byte each, see pack_cell
+    vec3 position = vec3(cell & 0xFFu, (cell >> 8) & 0xFFu, (cell >> 16) & 0xFFu);
+    fragment_color = cell_color(cell >> 24, position);
+    gl_Position = MVP * vec4(position + CUBE_STRIP[gl_VertexID], 1.0);
+}
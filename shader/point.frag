@@ -0,0 +1,37 @@
+#version 420 core
+
+flat in vec3 fragment_color;
+flat in vec3 center;
+out vec4 frag_colour;
+
+uniform mat4 MVP;
+uniform mat4 inverse_MVP;
+// size of the framebuffer in pixels
+uniform vec2 viewport;
+
+void main() {
+    vec2 ndc = gl_FragCoord.xy / viewport * 2.0 - 1.0;
+    vec4 near = inverse_MVP * vec4(ndc, -1.0, 1.0);
+    vec4 far = inverse_MVP * vec4(ndc, 1.0, 1.0);
+
+    // ray from the near to the far plane, in cell coordinates
+    vec3 origin = near.xyz / near.w;
+    vec3 direction = far.xyz / far.w - origin;
+    // axis aligned rays would divide by zero
+    direction = mix(direction, vec3(1e-6), lessThan(abs(direction), vec3(1e-6)));
+
+    vec3 lower = (center - 0.5 - origin) / direction;
+    vec3 upper = (center + 0.5 - origin) / direction;
+    vec3 enters = min(lower, upper);
+    vec3 leaves = max(lower, upper);
+    float enter = max(enters.x, max(enters.y, enters.z));
+    float leave = min(leaves.x, min(leaves.y, leaves.z));
+    // the corners of the point miss the cube
+    if (enter > leave || leave < 0.0) {
+        discard;
+    }
+
+    vec4 clip = MVP * vec4(origin + direction * max(enter, 0.0), 1.0);
+    gl_FragDepth = (clip.z / clip.w) * 0.5 + 0.5;
+    frag_colour = vec4(fragment_color, 1.0);
+}
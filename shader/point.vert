@@ -0,0 +1,20 @@
+#version 420 core
+#include "color.glsl"
+
+in uint cell;
+
+flat out vec3 fragment_color;
+flat out vec3 center;
+
+uniform mat4 MVP;
+// pixels covered by one cell at a distance of one cell
+uniform float pixel_scale;
+
+void main() {
+    // x, y, z and state packed one byte each, see pack_cell
+    center = vec3(cell & 0xFFu, (cell >> 8) & 0xFFu, (cell >> 16) & 0xFFu);
+    fragment_color = cell_color(cell >> 24, center);
+    gl_Position = MVP * vec4(center, 1.0);
+    // wide enough for the sphere around the cube, plus a pixel of rounding
+    gl_PointSize = sqrt(3.0) * pixel_scale / gl_Position.w + 1.0;
+}
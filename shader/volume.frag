@@ -0,0 +1,77 @@
+#version 420 core
+#include "color.glsl"
+
+in vec2 ndc;
+out vec4 frag_colour;
+
+uniform mat4 MVP;
+uniform mat4 inverse_MVP;
+// state of every cell, mip level n holding level n of the Life pyramid,
+// which is nonzero wherever its block holds a live cell
+uniform usampler3D cells;
+
+// see LOD_LEVELS in include/cell/cell.hpp
+const uint LOD_LEVELS = 4u;
+const int MAX_STEPS = 1024;
+
+void main() {
+    vec4 near = inverse_MVP * vec4(ndc, -1.0, 1.0);
+    vec4 far = inverse_MVP * vec4(ndc, 1.0, 1.0);
+
+    // from here on cell c covers [c, c + 1) instead of [c - 0.5, c + 0.5)
+    vec3 origin = near.xyz / near.w + 0.5;
+    vec3 direction = normalize(far.xyz / far.w - near.xyz / near.w);
+    // axis aligned rays would divide by zero
+    direction = mix(direction, vec3(1e-6), lessThan(abs(direction), vec3(1e-6)));
+    vec3 inverse_direction = 1.0 / direction;
+
+    vec3 lower = (vec3(0.0) - origin) * inverse_direction;
+    vec3 upper = (vec3(dimension) - origin) * inverse_direction;
+    vec3 enters = min(lower, upper);
+    vec3 leaves = max(lower, upper);
+    float enter = max(max(enters.x, enters.y), max(enters.z, 0.0));
+    float leave = min(leaves.x, min(leaves.y, leaves.z));
+
+    if (enter >= leave) {
+        discard;
+    }
+
+    // descend the pyramid into occupied blocks and step over empty ones,
+    // moving the cell itself across the face the ray leaves through so
+    // rounding can never keep it in the same block
+    ivec3 cell = clamp(ivec3(floor(origin + direction * enter)), 0, int(dimension) - 1);
+    uint level = LOD_LEVELS;
+    for (int i = 0; i < MAX_STEPS; i += 1) {
+        uint state = texelFetch(cells, cell >> level, int(level)).r;
+        if (state != 0u) {
+            if (level == 0u) {
+                // depth of the point where the ray enters the cell
+                vec3 faces = mix(vec3(cell), vec3(cell + 1), lessThan(direction, vec3(0.0)));
+                vec3 entries = (faces - origin) * inverse_direction;
+                float t = max(enter, max(entries.x, max(entries.y, entries.z)));
+                vec4 clip = MVP * vec4(origin + direction * t - 0.5, 1.0);
+                gl_FragDepth = (clip.z / clip.w) * 0.5 + 0.5;
+                frag_colour = vec4(cell_color(state, vec3(cell)), 1.0);
+                return;
+            }
+            level -= 1u;
+            continue;
+        }
+
+        ivec3 block_lower = (cell >> level) << level;
+        ivec3 block_upper = block_lower + (1 << level);
+        vec3 faces = mix(vec3(block_lower), vec3(block_upper), greaterThan(direction, vec3(0.0)));
+        vec3 exits = (faces - origin) * inverse_direction;
+        int axis = exits.x < exits.y ? (exits.x < exits.z ? 0 : 2) : (exits.y < exits.z ? 1 : 2);
+
+        ivec3 next = clamp(ivec3(floor(origin + direction * exits[axis])), block_lower, block_upper - 1);
+        next[axis] = direction[axis] > 0.0 ? block_upper[axis] : block_lower[axis] - 1;
+        if (any(lessThan(next, ivec3(0))) || any(greaterThanEqual(next, ivec3(dimension)))) {
+            break;
+        }
+
+        cell = next;
+        level = min(level + 1u, LOD_LEVELS);
+    }
+    discard;
+}
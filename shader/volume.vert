@@ -0,0 +1,10 @@
+#version 420 core
+
+// position of the fragment in normalized device coordinates
+out vec2 ndc;
+
+void main() {
+    // one triangle covering the whole screen
+    ndc = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    gl_Position = vec4(ndc, 0.0, 1.0);
+}
@@ -1,12 +1,27 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <initializer_list>
+#include <optional>
+#include <utility>
 
 #include <cell/app.hpp>
 #include <cell/cell.hpp>
+#include <cell/memory.hpp>
+#include <cell/raycast.hpp>
+#include <cell/record.hpp>
 #include <cell/shader.hpp>
+#include <cell/simulation.hpp>
+#include <cell/trace.hpp>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <util/util.hpp>
 
@@ -17,51 +32,10 @@ constexpr auto cell_rule_default(u8 count) -> bool {
     return count == 4;
 }
 
-constexpr auto cell_color_default(
-    f32 /*unused*/, u8 /*unused*/, CellState state, u8 /*x*/, u8 /*y*/, u8 /*z*/
-) -> glm::vec3 {
-    f32 t = 0.0F;
-    switch (state) {
-        case 1:
-            t = 0.9F;
-            break;
-        case 2:
-            t = 0.6F;
-            break;
-        case 3:
-            t = 0.3F;
-            break;
-        case 4:
-            t = 0.09F;
-            break;
-        default:
-            break;
-    }
-
-    return {1.0, t, 0};
-}
-
 constexpr auto cell_rule_6_8(u8 count) -> bool {
     return count >= 6 && count <= 8;
 }
 
-constexpr auto distance_from_center(u8 x, u8 y, u8 z, u8 dimension) -> f32 {
-    u32 const dx     = (x - (dimension >> 1U));
-    u32 const dy     = (y - (dimension >> 1U));
-    u32 const dz     = (z - (dimension >> 1U));
-    u32 const square = (dx * dx) + (dy * dy) + (dz * dz);
-    return static_cast<f32>(square);
-}
-
-constexpr auto cell_color_6_8(
-    f32 max_distance, u8 dimension, CellState /*state*/, u8 x, u8 y, u8 z
-) -> glm::vec3 {
-    f32 const distance = distance_from_center(x, y, z, dimension);
-    f32 const t        = std::sqrt(distance / max_distance);
-
-    return {0.1, 1 - t, t};
-}
-
 constexpr auto cell_alive_rule_cloud(u8 count) -> bool {
     return count >= 13 && count <= 26;
 }
@@ -70,16 +44,6 @@ constexpr auto cell_dead_rule_cloud(u8 count) -> bool {
     return count == 13 || count == 14 || (count >= 17 && count <= 19);
 }
 
-constexpr auto cell_color_cloud(
-    f32 /*max_distance*/, u8 dimension, CellState /*state*/, u8 x, u8 y, u8 z
-) -> glm::vec3 {
-    glm::vec3 color;
-    color[0] = static_cast<f32>(x) / static_cast<f32>(dimension);
-    color[1] = static_cast<f32>(y) / static_cast<f32>(dimension);
-    color[2] = static_cast<f32>(z) / static_cast<f32>(dimension);
-    return color;
-}
-
 constexpr auto cell_alive_rule_decay(u8 count) -> bool {
     switch (count) {
         case 1:
@@ -96,19 +60,53 @@ constexpr auto cell_dead_rule_decay(u8 count) -> bool {
     return count >= 13 && count <= 26;
 }
 
-constexpr auto cell_color_decay(
-    f32 max_distance, u8 dimension, CellState /*state*/, u8 x, u8 y, u8 z
-) -> glm::vec3 {
-    f32 const distance = distance_from_center(x, y, z, dimension);
-    f32 const t        = distance / max_distance;
-
-    return {t, 0.0, 0.1};
-}
+// largest multiple of 4 that fits the u8 coordinates of Life
+constexpr i32 MAX_DIMENSION = 252;
 
 void framebuffer_size(GLFWwindow * /*window*/, int width, int height) {
     glViewport(0, 0, width, height);
 }
 
+auto perspective(u8 dimension, f32 aspect_ratio) -> glm::mat4 {
+    // far enough to see the whole world from the orbit of orbit_camera
+    f32 const far = static_cast<f32>(dimension) * 4.0F;
+    return glm::perspective<f32>(
+        glm::pi<f32>() / 4.0F, aspect_ratio, 0.1F, far
+    );
+}
+
+auto seconds_since(std::chrono::steady_clock::time_point start) -> f64 {
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+// Camera circling the world, time seconds into its orbit, looking through
+// projection at a framebuffer of viewport pixels.
+auto orbit_camera(
+    u8 dimension, glm::mat4 const &projection, f32 time, glm::vec2 viewport
+) -> Camera {
+    f32 const radius = static_cast<f32>(dimension) * 2.1F;
+    f32 const cam_x  = std::sin(time / 5) * radius;
+    f32 const cam_y  = dimension;
+    f32 const cam_z  = std::cos(time / 5) * radius;
+
+    glm::vec3 const eye_pos(cam_x, cam_y, cam_z);
+    glm::vec3 constexpr center(0.0, 0.0, 0.0);
+    glm::vec3 constexpr up(0.0, 1.0, 0.0);
+
+    auto view = glm::lookAt(eye_pos, center, up);
+
+    f32 const start     = -static_cast<f32>(dimension >> 1) + 0.5F;
+    auto      translate = glm::translate(view, {start, start, start});
+
+    return {
+        .mvp         = projection * translate,
+        .eye         = eye_pos - start,
+        .viewport    = viewport,
+        .pixel_scale = projection[1][1] * viewport.y / 2,
+    };
+}
+
 } // namespace
 
 // rules taken from
@@ -116,7 +114,15 @@ void framebuffer_size(GLFWwindow * /*window*/, int width, int height) {
 static LifeRule const DEFAULT_RULE = {
     .alive_rule        = cell_rule_default,
     .dead_rule         = cell_rule_default,
-    .cell_color        = cell_color_default,
+    .cell_color =
+        {.gradient = ColorGradient::State,
+         .palette  = {{
+             {1.0, 0.0, 0.0},
+             {1.0, 0.9, 0.0},
+             {1.0, 0.6, 0.0},
+             {1.0, 0.3, 0.0},
+             {1.0, 0.09, 0.0},
+         }}},
     .state_count       = 5,
     .start_dead_chance = 0.85
 };
@@ -124,7 +130,10 @@ static LifeRule const DEFAULT_RULE = {
 static LifeRule const SIX_EIGHT_RULE = {
     .alive_rule        = cell_rule_6_8,
     .dead_rule         = cell_rule_6_8,
-    .cell_color        = cell_color_6_8,
+    .cell_color =
+        {.gradient = ColorGradient::DistanceSqrt,
+         .from     = {0.1, 1.0, 0.0},
+         .to       = {0.1, 0.0, 1.0}},
     .state_count       = 2,
     .start_dead_chance = 0.70,
 };
@@ -132,7 +141,7 @@ static LifeRule const SIX_EIGHT_RULE = {
 static LifeRule const CLOUD_RULE = {
     .alive_rule        = cell_alive_rule_cloud,
     .dead_rule         = cell_dead_rule_cloud,
-    .cell_color        = cell_color_cloud,
+    .cell_color        = {.gradient = ColorGradient::Position},
     .state_count       = 2,
     .start_dead_chance = 0.5,
 };
@@ -140,11 +149,22 @@ static LifeRule const CLOUD_RULE = {
 static LifeRule const DECAY_RULE = {
     .alive_rule        = cell_alive_rule_decay,
     .dead_rule         = cell_dead_rule_decay,
-    .cell_color        = cell_color_decay,
+    .cell_color =
+        {.gradient = ColorGradient::Distance,
+         .from     = {0.0, 0.0, 0.1},
+         .to       = {1.0, 0.0, 0.1}},
     .state_count       = 5,
     .start_dead_chance = 0.65,
 };
 
+// rules of the keys '1' to '4', and whether they start from a full world
+static std::array<std::pair<LifeRule, bool>, 4> const RULES = {{
+    {DEFAULT_RULE, false},
+    {SIX_EIGHT_RULE, false},
+    {CLOUD_RULE, true},
+    {DECAY_RULE, true},
+}};
+
 void scroll(GLFWwindow *window, double /*xoffset*/, double yoffset) {
     if (yoffset == 0.0) {
         return;
@@ -153,17 +173,20 @@ void scroll(GLFWwindow *window, double /*xoffset*/, double yoffset) {
     auto *state = static_cast<AppState *>(glfwGetWindowUserPointer(window));
     assert(state != nullptr);
 
-    if (yoffset > 0) {
-        state->life.resize(
-            static_cast<u8>(std::min(state->life.get_dimension() + 4, 100))
-        );
-    } else {
-        state->life.resize(
-            static_cast<u8>(std::max(state->life.get_dimension() - 4, 16))
-        );
-    }
-
-    state->restart();
+    i32 const dimension = state->simulation.get_dimension();
+    auto const resized  = static_cast<u8>(
+        yoffset > 0 ? std::min(dimension + 4, MAX_DIMENSION)
+                    : std::max(dimension - 4, 16)
+    );
+    LifeMemory const memory =
+        Simulation::estimate_memory(resized, state->life_rule.state_count);
+    eprintln(
+        "dimension {}: about {} of grids and {} of scratch",
+        resized,
+        format_bytes(memory.grid),
+        format_bytes(memory.scratch)
+    );
+    state->simulation.resize(resized);
 }
 
 void keyboard(
@@ -176,142 +199,130 @@ void keyboard(
     auto *state = static_cast<AppState *>(glfwGetWindowUserPointer(window));
     assert(state != nullptr);
 
-    bool restart = false;
+    u32 const rate = state->simulation.get_rate();
     switch (key) {
         case '1':
-            state->life_rule = DEFAULT_RULE;
-            restart          = true;
-            state->full_init = false;
-            break;
         case '2':
-            state->life_rule = SIX_EIGHT_RULE;
-            restart          = true;
-            state->full_init = false;
-            break;
         case '3':
-            state->life_rule = CLOUD_RULE;
-            restart          = true;
-            state->full_init = true;
-            break;
-        case '4':
-            state->life_rule = DECAY_RULE;
-            restart          = true;
-            state->full_init = true;
+        case '4': {
+            auto const &[rule, full_init] = RULES[key - '1'];
+            state->life_rule              = rule;
+            state->simulation.set_rule(rule, full_init);
             break;
+        }
+        // halve or double the generations per second, past the largest rate
+        // the simulation runs as fast as it can
         case GLFW_KEY_MINUS:
-            state->update_rate =
-                std::min(state->update_rate * 2, static_cast<usize>(256));
+            if (rate == 0) {
+                state->simulation.set_rate(MAX_GENERATION_RATE);
+            } else {
+                state->simulation.set_rate(std::max<u32>(rate / 2, 1));
+            }
             break;
         case GLFW_KEY_EQUAL:
-            if ((mods & GLFW_MOD_SHIFT) != 0) {
-                state->update_rate =
-                    std::max(state->update_rate / 2, static_cast<usize>(1));
+            if ((mods & GLFW_MOD_SHIFT) != 0 && rate != 0) {
+                state->simulation.set_rate(
+                    rate == MAX_GENERATION_RATE ? 0 : rate * 2
+                );
             }
             break;
         case GLFW_KEY_ENTER:
-            restart = true;
+            state->simulation.restart();
+            break;
+        case GLFW_KEY_LEFT_BRACKET:
+            state->lod_bias -= 1.0F;
+            break;
+        case GLFW_KEY_RIGHT_BRACKET:
+            state->lod_bias += 1.0F;
+            break;
+        case 'T':
+            dump_trace();
+            break;
+        case 'I':
+            print_memory();
+            break;
+        case 'G':
+            state->governor.set_enabled(!state->governor.is_enabled());
+            eprintln(
+                "governor: {}", state->governor.is_enabled() ? "on" : "off"
+            );
+            break;
+        case 'M':
+            switch (state->render_mode) {
+                case RenderMode::Cubes:
+                    state->render_mode = RenderMode::Points;
+                    break;
+                case RenderMode::Points:
+                    state->render_mode = RenderMode::Chunks;
+                    break;
+                case RenderMode::Chunks:
+                    state->render_mode = RenderMode::Volume;
+                    break;
+                case RenderMode::Volume:
+                    state->render_mode = RenderMode::Cubes;
+                    break;
+            }
             break;
         default:
             break;
     }
-    if (restart) {
-        state->restart();
-    }
 }
 
-void AppState::render() const {
-    f32 const time = static_cast<f32>(glfwGetTime());
-
-    f32 const radius = static_cast<f32>(this->life.get_dimension()) * 2.1F;
-    f32 const cam_x  = std::sin(time / 5) * radius;
-    f32 const cam_y  = this->life.get_dimension();
-    f32 const cam_z  = std::cos(time / 5) * radius;
-
-    glm::vec3 const eye_pos(cam_x, cam_y, cam_z);
-    glm::vec3 constexpr center(0.0, 0.0, 0.0);
-    glm::vec3 constexpr up(0.0, 1.0, 0.0);
-
-    auto view = glm::lookAt(eye_pos, center, up);
-
-    auto [points, colors] = this->life.draw(this->life_rule.cell_color);
-
-    this->shader_program.use();
+void AppState::render(f32 time, glm::vec2 viewport) {
+    Life const     &life = this->simulation.read();
+    glm::mat4 const projection =
+        perspective(life.get_dimension(), ASPECT_RATIO);
+    Camera const camera =
+        orbit_camera(life.get_dimension(), projection, time, viewport);
+    CellColor const   &color = this->life_rule.cell_color;
+    CounterScope const counters(Phase::Draw, life.size());
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glBindBuffer(GL_ARRAY_BUFFER, this->position_buffer);
-    glBufferData(
-        GL_ARRAY_BUFFER,
-        static_cast<isize>(points.size() * sizeof(glm::vec3)),
-        points.data(),
-        GL_STATIC_DRAW
-    );
-    glVertexAttribPointer(
-        this->vertex_position, 3, GL_FLOAT, GL_FALSE, 0, nullptr
-    );
-    glEnableVertexAttribArray(this->vertex_position);
-
-    glBindBuffer(GL_ARRAY_BUFFER, this->color_buffer);
-    glBufferData(
-        GL_ARRAY_BUFFER,
-        static_cast<isize>(colors.size() * sizeof(glm::vec3)),
-        colors.data(),
-        GL_STATIC_DRAW
-    );
-    glVertexAttribPointer(
-        this->vertex_color, 3, GL_FLOAT, GL_FALSE, 0, nullptr
-    );
-    glEnableVertexAttribArray(this->vertex_color);
-
-    f32 const start = -static_cast<f32>(this->life.get_dimension() >> 1) + 0.5F;
-    auto      translate = glm::translate(view, {start, start, start});
-    auto      mvp       = this->projection * translate;
-
-    glUniformMatrix4fv(this->mvp_location, 1, 0U, glm::value_ptr(mvp));
-    glDrawArrays(GL_POINTS, 0, static_cast<i32>(points.size()));
-
-    glDisableVertexAttribArray(this->vertex_position);
-    glDisableVertexAttribArray(this->vertex_color);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-}
-
-void AppState::update(usize value) {
-    if (value % this->update_rate == 0) {
-        f64 const start = glfwGetTime();
-        this->life.update(this->life_rule);
-        this->stats.update_count += 1;
-        this->stats.update_time += glfwGetTime() - start;
+    switch (this->render_mode) {
+        case RenderMode::Cubes:
+            this->cube_renderer.draw(life, color, camera, this->stats);
+            break;
+        case RenderMode::Points:
+            this->point_renderer.draw(life, color, camera, this->stats);
+            break;
+        case RenderMode::Chunks:
+            this->chunk_renderer.draw(life, color, camera, this->stats);
+            break;
+        case RenderMode::Volume:
+            this->volume_renderer.draw(life, color, camera, this->stats);
+            break;
     }
 }
 
-void AppState::restart() {
-    if (this->full_init) {
-        this->life.init_full_random(
-            this->life_rule.state_count, this->life_rule.start_dead_chance
-        );
-    } else if (this->life.get_dimension() <= 44) {
-        f64 const dead_chance = this->life_rule.start_dead_chance * 0.7;
-        this->life.init_full_random(this->life_rule.state_count, dead_chance);
-    } else {
-        f64 const dead_chance = this->life_rule.start_dead_chance;
-        this->life.init_center_random(this->life_rule.state_count, dead_chance);
-    }
-}
+AppState::AppState(bool visible)
+    : life_rule(CLOUD_RULE), simulation(100, CLOUD_RULE, true) {
 
-AppState::AppState()
-    : life(Life(100)), projection(
-                           glm::perspective<f32>(
-                               glm::pi<f32>() / 4.0F, ASPECT_RATIO, 0.1F, 300.0F
-                           )
-                       ),
-      life_rule(CLOUD_RULE) {
+#ifdef GLFW_PLATFORM_NULL
+    // without a display, fall back to Mesa's software renderer on the null
+    // platform of GLFW 3.4
+    bool const display = std::getenv("DISPLAY") != nullptr ||
+                         std::getenv("WAYLAND_DISPLAY") != nullptr;
+    if (!visible && !display) {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+#endif
 
     if (glfwInit() == 0) {
         panic("Failed to init GLFW");
     }
 
+    if (!visible) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef GLFW_PLATFORM_NULL
+        if (!display) {
+            glfwWindowHint(
+                GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API
+            );
+        }
+#endif
+    }
+
     this->window = glfwCreateWindow(
         WINDOW_WIDTH, WINDOW_HEIGHT, "3D Cellular Automaton", nullptr, nullptr
     );
@@ -331,81 +342,340 @@ AppState::AppState()
     glfwSetScrollCallback(this->window, scroll);
     glfwSetFramebufferSizeCallback(this->window, framebuffer_size);
 
-    this->shader_program = Shader(
-        "shader/shader.vert", "shader/shader.geom", "shader/shader.frag"
-    );
+    enable_parallel_compile();
+
+    // issued together so the driver can build them side by side
+    Shader cube("cube.vert", "shader.frag");
+    Shader point("point.vert", "point.frag");
+    Shader chunk("chunk.vert", "shader.frag");
+    Shader volume("volume.vert", "volume.frag");
+    for (Shader *shader : {&cube, &point, &chunk, &volume}) {
+        shader->wait();
+    }
+
+    this->cube_renderer   = CubeRenderer(cube);
+    this->point_renderer  = PointRenderer(point);
+    this->chunk_renderer  = ChunkRenderer(chunk);
+    this->volume_renderer = VolumeRenderer(volume);
 
     glClearColor(0.0F, 0.0F, 0.0F, 0.0F); // define a cor de fundo
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
-
-    glGenVertexArrays(1, &this->VAO);
-    glBindVertexArray(this->VAO);
-
-    glGenBuffers(1, &this->position_buffer);
-    glGenBuffers(1, &this->color_buffer);
-
-    glBindVertexArray(0);
-
-    std::optional<i32> const vertex_pos =
-        this->shader_program.get_attribute("vertex_position");
-    std::optional<i32> const vertex_color =
-        this->shader_program.get_attribute("vertex_color");
-    std::optional<i32> const mvp = this->shader_program.get_uniform("MVP");
-    if (!vertex_pos.has_value() || !vertex_color.has_value() ||
-        !mvp.has_value()) {
-        panic("Failed to get position of attribute");
-    }
-    this->vertex_position = vertex_pos.value();
-    this->vertex_color    = vertex_color.value();
-    this->mvp_location    = mvp.value();
-
-    this->restart();
 }
 
 AppState::~AppState() {
     try {
-        f64 const update_avg = this->stats.update_time /
-                               static_cast<f64>(this->stats.update_count);
-        f64 const draw_avg =
-            this->stats.draw_time / static_cast<f64>(this->stats.draw_count);
-        eprintln("update: {} ms", update_avg * 1000.0F);
-        eprintln("draw: {} ms", draw_avg * 1000.0F);
-        glDeleteVertexArrays(1, &this->VAO);
-        glDeleteBuffers(1, &this->position_buffer);
-        glDeleteBuffers(1, &this->color_buffer);
+        std::optional<StatsWriter>   no_writer{};
+        std::optional<MetricsServer> no_metrics{};
+        this->flush_stats(no_writer, no_metrics, glfwGetTime());
+        this->stats.print();
+        if (this->gpu_timers.get_dropped() != 0) {
+            eprintln(
+                "gpu: {} frames untimed, their queries were not ready",
+                this->gpu_timers.get_dropped()
+            );
+        }
+        print_memory();
+        this->cube_renderer.destroy();
+        this->point_renderer.destroy();
+        this->chunk_renderer.destroy();
+        this->volume_renderer.destroy();
+        this->gpu_timers.destroy();
+        this->scaled_target.destroy();
         glfwTerminate();
     } catch (...) {
         std::cerr << "exception";
     }
 }
 
-void AppState::run() {
-    usize iteration   = 0;
+void AppState::run(RunOptions const &options) {
+    // before the simulation thread starts, so it is named
+    if (options.trace.has_value()) {
+        start_tracing(options.trace.value());
+    }
+    set_trace_thread_name("render");
+    if (options.counters) {
+        start_counters();
+    }
+    if (!options.budget.has_value()) {
+        this->simulation.start();
+    }
+    this->governor = Governor(options.frame_target);
+    this->stats.set_gpu_timers(&this->gpu_timers);
+    std::optional<StatsWriter> writer{};
+    if (options.stats.has_value()) {
+        writer.emplace(options.stats.value());
+    }
+    std::optional<MetricsServer> metrics{};
+    if (options.metrics.has_value()) {
+        metrics.emplace(options.metrics.value());
+    }
+
     usize frame_count = 0;
     usize n           = 0;
     f64   last        = glfwGetTime();
     while (glfwWindowShouldClose(this->window) == 0) {
+        TraceZone const zone("frame");
+
+        i32 width  = 0;
+        i32 height = 0;
+        glfwGetFramebufferSize(this->window, &width, &height);
+        glm::ivec2 const window(width, height);
+
+        this->chunk_renderer.set_lod_bias(
+            this->lod_bias + this->governor.get_lod_bias()
+        );
+        this->simulation.set_throttle(this->governor.get_throttle());
+        f32 const scale = this->governor.get_render_scale();
+
         f64 const start = glfwGetTime();
-        this->render();
-        this->stats.draw_count += 1;
-        this->stats.draw_time += glfwGetTime() - start;
+        std::optional<f64> const gpu_time =
+            this->gpu_timers.begin_frame(this->stats);
+        if (gpu_time.has_value()) {
+            this->governor.measure_gpu(gpu_time.value());
+        }
+        if (scale < 1.0F) {
+            glm::ivec2 const size = this->scaled_target.bind(window, scale);
+            this->render(static_cast<f32>(start), glm::vec2(size));
+            this->scaled_target.resolve(window);
+        } else {
+            this->render(static_cast<f32>(start), glm::vec2(window));
+        }
+        this->gpu_timers.end_frame();
+        f64 const draw_time = glfwGetTime() - start;
+        this->stats.record(Phase::Draw, draw_time);
 
         frame_count += 1;
         f64 const current = glfwGetTime();
-        if (current - last >= 1.0F) {
+        if (current - last >= STATS_INTERVAL) {
             f64 fps = static_cast<f64>(frame_count) / (current - last);
-            eprintln("[{}] fps: {}", n, fps);
+            eprintln(
+                "[{}] fps: {}, generation: {}",
+                n,
+                fps,
+                this->simulation.read().get_generation()
+            );
+            this->flush_stats(writer, metrics, current);
             n += 1;
             frame_count = 0;
             last        = current;
         }
-        this->update(iteration);
-        iteration += 1;
+
+        f64 update_time = 0.0;
+        if (options.budget.has_value()) {
+            f64 const update_start = glfwGetTime();
+            this->simulation.advance(
+                this->governor.get_update_budget(options.budget.value())
+            );
+            update_time = glfwGetTime() - update_start;
+        }
+        this->governor.measure(draw_time, update_time);
 
         glfwPollEvents();
-        glfwSwapBuffers(this->window);
+        {
+            PhaseTimer const timer(this->stats, Phase::Swap);
+            glfwSwapBuffers(this->window);
+        }
+    }
+    this->flush_stats(writer, metrics, glfwGetTime());
+    dump_trace();
+}
+
+void AppState::flush_stats(
+    std::optional<StatsWriter>   &writer,
+    std::optional<MetricsServer> &metrics,
+    f64                           time
+) {
+    this->stats.merge(Phase::Update, this->simulation.take_updates());
+    this->stats.take_counters();
+    Life const &life = this->simulation.read();
+    if (writer.has_value()) {
+        writer->write(this->stats, time, life.get_generation());
+    }
+    if (metrics.has_value()) {
+        metrics->publish(this->stats, life, time);
     }
+    this->stats.flush();
+}
+
+void AppState::record(RecordOptions const &options) {
+    // never started, so every generation is stepped here in time with the
+    // frames
+    auto const &[rule, full_init] = RULES.at(options.rule - 1);
+    this->life_rule               = rule;
+    this->simulation.set_rule(rule, full_init);
+    this->simulation.step();
+
+    // the default framebuffer of a hidden window may have no pixels at all
+    GLuint framebuffer = 0;
+    GLuint color       = 0;
+    GLuint depth       = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &color);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(
+        GL_RENDERBUFFER, GL_RGBA8, WINDOW_WIDTH, WINDOW_HEIGHT
+    );
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(
+        GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, WINDOW_WIDTH, WINDOW_HEIGHT
+    );
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color
+    );
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth
+    );
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        panic("Failed to create framebuffer");
+    }
+    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+    f64 const start = glfwGetTime();
+    {
+        FrameReader  reader(WINDOW_WIDTH, WINDOW_HEIGHT);
+        FrameEncoder encoder(options.output, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+        // one generation per frame, on a clock of the video itself
+        for (u32 frame = 0; frame < options.frames; frame += 1) {
+            f32 const time =
+                static_cast<f32>(frame) / static_cast<f32>(RECORD_FRAME_RATE);
+
+            f64 const draw_start = glfwGetTime();
+            this->render(time, glm::vec2(WINDOW_WIDTH, WINDOW_HEIGHT));
+            std::optional<Image> image = reader.read();
+            this->stats.record(Phase::Draw, glfwGetTime() - draw_start);
+
+            if (image.has_value()) {
+                encoder.push(std::move(image.value()));
+            }
+
+            this->simulation.step();
+        }
+
+        for (Image &image : reader.flush()) {
+            encoder.push(std::move(image));
+        }
+        reader.destroy();
+    }
+    f64 const elapsed = glfwGetTime() - start;
+    eprintln(
+        "recorded {} frames in {} s, {} fps",
+        options.frames,
+        elapsed,
+        static_cast<f64>(options.frames) / elapsed
+    );
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &color);
+    glDeleteRenderbuffers(1, &depth);
+}
+
+void run_headless(HeadlessOptions const &options) {
+    auto const &[rule, full_init] = RULES.at(options.rule - 1);
+
+    LifeMemory const estimate =
+        Life::estimate_memory(options.dimension, rule.state_count);
+    LifeMemory const view_estimate =
+        Life::estimate_view_memory(options.dimension);
+    eprintln(
+        "dimension {}: about {} of grids and {} of scratch",
+        options.dimension,
+        format_bytes(estimate.grid + view_estimate.grid),
+        format_bytes(estimate.scratch)
+    );
+    Life life(options.dimension);
+    init_life(life, rule, full_init);
+    // what the raycaster and the metrics read, as the Nibbles engine keeps
+    // its cells packed
+    Life view = life.get_view();
+
+    glm::mat4 const projection = perspective(
+        options.dimension,
+        static_cast<f32>(options.width) / static_cast<f32>(options.height)
+    );
+    Raycaster raycaster(options.width, options.height);
+
+    std::filesystem::create_directories(options.output);
+
+    Stats                      stats{};
+    std::optional<StatsWriter> writer{};
+    if (options.stats.has_value()) {
+        writer.emplace(options.stats.value());
+    }
+    if (options.trace.has_value()) {
+        start_tracing(options.trace.value());
+    }
+    set_trace_thread_name("main");
+    if (options.counters) {
+        start_counters();
+    }
+    std::optional<MetricsServer> metrics{};
+    if (options.metrics.has_value()) {
+        metrics.emplace(options.metrics.value());
+    }
+    // writes and publishes the latencies since the last flush, then adds
+    // them to the totals
+    auto const flush = [&](f64 time) {
+        stats.take_counters();
+        if (writer.has_value()) {
+            writer->write(stats, time, life.get_generation());
+        }
+        if (metrics.has_value()) {
+            life.copy_view_to(view);
+            metrics->publish(stats, view, time);
+        }
+        stats.flush();
+    };
+
+    auto const run_start = std::chrono::steady_clock::now();
+    f64        last      = 0.0;
+    for (u32 generation = 0;; generation += 1) {
+        if (generation % options.every == 0) {
+            // one orbit about every 300 generations
+            Camera const camera = orbit_camera(
+                options.dimension,
+                projection,
+                static_cast<f32>(generation) / 10.0F,
+                glm::vec2(options.width, options.height)
+            );
+
+            life.copy_view_to(view);
+            auto const         start = std::chrono::steady_clock::now();
+            TraceZone const    zone("Raycaster::draw");
+            CounterScope const counters(Phase::Draw, view.size());
+            Image const       &image =
+                raycaster.draw(view, rule.cell_color, camera);
+            stats.record(Phase::Draw, seconds_since(start));
+
+            write_ppm(
+                image, options.output / std::format("{:06}.ppm", generation)
+            );
+        }
+        if (generation == options.generations) {
+            break;
+        }
+
+        auto const start = std::chrono::steady_clock::now();
+        life.update(rule);
+        stats.record(Phase::Update, seconds_since(start));
+
+        f64 const time = seconds_since(run_start);
+        if (time - last >= STATS_INTERVAL) {
+            flush(time);
+            last = time;
+        }
+    }
+
+    flush(seconds_since(run_start));
+    stats.print();
+    print_memory();
+    dump_trace();
 }
 
 } // namespace cell
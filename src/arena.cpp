@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cell/arena.hpp>
+#include <cell/memory.hpp>
+#include <util/util.hpp>
+
+namespace cell {
+
+namespace {
+// A mapping of a block, rounded up to pages.
+struct Block {
+    void *data;
+    usize size;
+};
+
+struct Cache {
+    std::mutex         mutex;
+    // freed blocks, oldest first
+    std::vector<Block> blocks;
+    // freed grids are still grids, until they are unmapped
+    MemoryAccount      memory{Memory::Grid};
+
+    // so freeing a block never allocates
+    Cache() {
+        this->blocks.reserve(ARENA_CACHE_SIZE);
+    }
+};
+
+std::atomic<bool> reserved = false;
+
+auto cache() -> Cache & {
+    static Cache cache{};
+    return cache;
+}
+
+auto mapped_size(usize bytes) -> usize {
+    static usize const page = static_cast<usize>(sysconf(_SC_PAGESIZE));
+    usize const        unit = bytes >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : page;
+    return (bytes + unit - 1) / unit * unit;
+}
+
+auto map_anonymous(usize size, i32 flags) -> void * {
+    return mmap(
+        nullptr,
+        size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | flags,
+        -1,
+        0
+    );
+}
+
+auto map(usize size) -> void * {
+    if (size % HUGE_PAGE_SIZE != 0) {
+        void *const data = map_anonymous(size, 0);
+        if (data == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        return data;
+    }
+
+#ifdef MAP_HUGETLB
+    if (reserved.load(std::memory_order_relaxed)) {
+        void *const data = map_anonymous(size, MAP_HUGETLB);
+        if (data != MAP_FAILED) {
+            return data;
+        }
+        if (reserved.exchange(false, std::memory_order_relaxed)) {
+            eprintln("arena: out of reserved huge pages, using transparent");
+        }
+    }
+#endif
+
+    // a huge page more than needed, trimmed to a range aligned to one, so
+    // the kernel can back it with huge pages
+    auto *const base =
+        static_cast<u8 *>(map_anonymous(size + HUGE_PAGE_SIZE, 0));
+    if (base == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    usize const misalignment =
+        reinterpret_cast<std::uintptr_t>(base) % HUGE_PAGE_SIZE;
+    usize const head = misalignment == 0 ? 0 : HUGE_PAGE_SIZE - misalignment;
+    if (head != 0) {
+        munmap(base, head);
+    }
+    if (head != HUGE_PAGE_SIZE) {
+        munmap(base + head + size, HUGE_PAGE_SIZE - head);
+    }
+    void *const data = base + head;
+#ifdef MADV_HUGEPAGE
+    madvise(data, size, MADV_HUGEPAGE);
+#endif
+    return data;
+}
+} // namespace
+
+auto arena_allocate(usize bytes) -> void * {
+    if (bytes < MIN_MAPPED_SIZE) {
+        void *const block =
+            ::operator new(bytes, std::align_val_t{GRID_ALIGNMENT});
+        std::memset(block, 0, bytes);
+        return block;
+    }
+
+    usize const size  = mapped_size(bytes);
+    void       *block = nullptr;
+    {
+        Cache                 &cache = cell::cache();
+        std::scoped_lock const lock(cache.mutex);
+        auto const             reused =
+            std::ranges::find(cache.blocks, size, &Block::size);
+        if (reused != cache.blocks.end()) {
+            block = reused->data;
+            cache.blocks.erase(reused);
+            cache.memory.set(cache.memory.get_bytes() - size);
+        }
+    }
+    if (block == nullptr) {
+        return map(size);
+    }
+    // a mapping starts zeroed, a block reused was written to
+    std::memset(block, 0, bytes);
+    return block;
+}
+
+void arena_deallocate(void *block, usize bytes) noexcept {
+    if (bytes < MIN_MAPPED_SIZE) {
+        ::operator delete(block, std::align_val_t{GRID_ALIGNMENT});
+        return;
+    }
+
+    usize const size    = mapped_size(bytes);
+    Block       evicted = {.data = nullptr, .size = 0};
+    {
+        Cache                 &cache = cell::cache();
+        std::scoped_lock const lock(cache.mutex);
+        if (cache.blocks.size() == ARENA_CACHE_SIZE) {
+            evicted = cache.blocks.front();
+            cache.blocks.erase(cache.blocks.begin());
+        }
+        cache.blocks.push_back({.data = block, .size = size});
+        cache.memory.set(cache.memory.get_bytes() + size - evicted.size);
+    }
+    if (evicted.data != nullptr) {
+        munmap(evicted.data, evicted.size);
+    }
+}
+
+void use_reserved_huge_pages() {
+#ifdef MAP_HUGETLB
+    reserved.store(true, std::memory_order_relaxed);
+#else
+    eprintln("arena: reserved huge pages are not supported here");
+#endif
+}
+
+} // namespace cell
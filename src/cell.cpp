@@ -1,20 +1,23 @@
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <cassert>
 #include <mutex>
+#include <optional>
 #include <random>
 #include <thread>
 
 #include <cell/alias.hpp>
 #include <cell/cell.hpp>
+#include <cell/stats.hpp>
+#include <cell/trace.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <util/util.hpp>
 
 namespace cell {
 
 namespace {
-constexpr u8 THREAD_COUNT = 16;
-
 inline auto random_state(u8 state_count, f64 dead_chance) -> CellState {
     static thread_local std::random_device r;
     static thread_local std::mt19937       generator(r());
@@ -27,17 +30,111 @@ inline auto random_state(u8 state_count, f64 dead_chance) -> CellState {
     return 0;
 }
 
-constexpr auto toroidal(i8 n, u8 dimension) -> u8 {
+constexpr auto toroidal(i16 n, u8 dimension) -> u8 {
     if (n < 0) {
         return dimension - 1;
     }
-    u8 const un = n;
-    if (un == dimension) {
+    if (n == dimension) {
         return 0;
     }
-    return un;
+    return static_cast<u8>(n);
+}
+
+// Most common live state among the children of a pyramid cell.
+constexpr auto dominant_state(std::array<CellState, 8> const &children)
+    -> CellState {
+    CellState dominant = 0;
+    usize     best     = 0;
+    for (CellState const state : children) {
+        if (state == 0) {
+            continue;
+        }
+        usize const count = std::ranges::count(children, state);
+        if (count > best) {
+            dominant = state;
+            best     = count;
+        }
+    }
+    return dominant;
 }
 
+// cells of a 3x3x3 neighbourhood, so counts are below it
+constexpr u8 NEIGHBOURHOOD = 27;
+
+// words of the longest row of a plane
+constexpr u32 MAX_ROW_WORDS = MAX_AXIS / 64;
+
+// bits of a count of live neighbours, up to 26
+constexpr u32 COUNT_BITS = 5;
+
+// planes of the bits of the states of a rule, at least one
+constexpr auto count_planes(u8 state_count) -> u8 {
+    return static_cast<u8>(
+        std::max<u32>(std::bit_width(static_cast<u32>(state_count - 1)), 1)
+    );
+}
+
+// bytes of the planes, or the next planes, of the Planes engine
+constexpr auto plane_bytes(u8 dimension, u8 state_count) -> usize {
+    return static_cast<usize>(dimension) * dimension *
+           (count_planes(state_count) + 1U) * ((dimension + 63U) / 64U) *
+           sizeof(u64);
+}
+
+// whether range holds coordinate, along an axis of dimension cells
+constexpr auto
+contains(AxisRange const &range, u32 coordinate, u32 dimension) -> bool {
+    return ((coordinate + dimension - range.first) % dimension) < range.length;
+}
+
+// Smallest range holding every coordinate marked along an axis of dimension
+// cells, the complement of the longest run of unmarked ones, which may wrap
+// around the axis.
+auto cover(std::array<u8, MAX_AXIS> const &marked, u32 dimension)
+    -> AxisRange {
+    bool any     = false;
+    u32  gap     = 0;
+    u32  gap_end = 0;
+    u32  run     = 0;
+    // twice around, so a run across the end is measured whole
+    for (u32 i = 0; i < 2 * dimension; i += 1) {
+        if (marked[i % dimension] != 0) {
+            any = true;
+            run = 0;
+            continue;
+        }
+        run += 1;
+        if (run > gap) {
+            gap     = run;
+            gap_end = (i + 1) % dimension;
+        }
+    }
+    if (!any) {
+        return {.first = 0, .length = 0};
+    }
+    return {
+        .first  = static_cast<u8>(gap_end),
+        .length = static_cast<u16>(dimension - gap),
+    };
+}
+
+// Sizes a grid of an engine to size elements, freeing it for 0. A grid of
+// that size already is kept as it is, as pack and the engine overwrite it
+// before reading it, so a restart neither frees and takes it back from the
+// arena nor clears it again.
+template <typename Grid> void fit(Grid &grid, usize size) {
+    if (grid.size() == size) {
+        return;
+    }
+    // rather than resizing, which would copy the cells held; assigning {}
+    // would pick the initializer list and keep the storage
+    grid = Grid{};
+    grid.resize(size);
+}
+
+// set by prefer_engine before any Life is initialised
+std::optional<LifeEngine> preferred{};
+
 } // namespace
 
 Life::Life(u8 dimension) {
@@ -45,14 +142,430 @@ Life::Life(u8 dimension) {
 }
 
 void Life::resize(u8 dimension) {
-    u32 const size = dimension * dimension * dimension;
-
-    assert(size % THREAD_COUNT == 0);
-
     this->dimension = dimension;
+    assert(this->size() % THREAD_COUNT == 0);
     this->max_distance =
         3.0F * static_cast<f32>((dimension >> 1U) * (dimension >> 1U));
-    this->cells.resize(size, 0);
+
+    this->chunk_count =
+        static_cast<u8>((dimension + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    usize const chunks = static_cast<usize>(this->chunk_count) *
+                         this->chunk_count * this->chunk_count;
+    this->chunk_stamps.resize(chunks);
+    this->next_touched.resize(chunks);
+    for (u8 level = 1; level <= LOD_LEVELS; level += 1) {
+        u32 const side = this->get_level_dimension(level);
+        this->pyramid[level - 1].resize(side * side * side);
+    }
+    // the cells and the grids of the engine are left to the init that
+    // follows, which sizes them for the engine it picks, so sizing them here
+    // for another would only leave a freed copy in the arena cache; the live
+    // box keeps draw from reading them meanwhile
+    this->live_box = {};
+    this->touch_all();
+    this->account_memory();
+}
+
+void Life::set_engine(LifeEngine engine, u8 plane_count) {
+    usize const size = this->size();
+    usize const plane_words =
+        static_cast<usize>(this->dimension) * this->dimension *
+        (plane_count + 1U) * this->get_row_words();
+    usize const slabs = this->dimension;
+    this->engine      = engine;
+    this->plane_count = plane_count;
+
+    // sizes of the grids of every engine, 0 for those of the others
+    auto const of = [engine](LifeEngine user, usize size) -> usize {
+        return engine == user ? size : 0;
+    };
+    // the flips and stale slabs are used by both of these
+    bool const  deferred =
+        engine == LifeEngine::Counts || engine == LifeEngine::Frontier;
+    usize const lists = deferred ? slabs : 0;
+    fit(this->cells, engine == LifeEngine::Nibbles ? 0 : size);
+    fit(this->next_cells, of(LifeEngine::Bytes, size));
+    fit(this->packed, of(LifeEngine::Nibbles, size / 2));
+    fit(this->next_packed, of(LifeEngine::Nibbles, size / 2));
+    fit(this->planes, of(LifeEngine::Planes, plane_words));
+    fit(this->next_planes, of(LifeEngine::Planes, plane_words));
+    fit(this->counts, of(LifeEngine::Counts, size));
+    fit(this->queued, of(LifeEngine::Counts, size));
+    fit(this->candidates, of(LifeEngine::Counts, slabs));
+    fit(this->next_candidates, of(LifeEngine::Counts, slabs));
+    fit(this->active, of(LifeEngine::Frontier, (size + 63) / 64));
+    fit(this->next_active, of(LifeEngine::Frontier, (size + 63) / 64));
+    fit(this->changes, of(LifeEngine::Frontier, slabs));
+    fit(this->flips, lists);
+    fit(this->stale_slabs, lists);
+    this->account_memory();
+}
+
+void Life::pack() {
+    if (this->engine == LifeEngine::Counts ||
+        this->engine == LifeEngine::Frontier) {
+        this->recount();
+        return;
+    }
+    if (this->engine != LifeEngine::Planes) {
+        return;
+    }
+
+    u32 const dimension = this->dimension;
+    u32 const words     = this->get_row_words();
+    u32 const stride    = (this->plane_count + 1U) * words;
+    std::ranges::fill(this->planes, 0);
+    for (u32 row = 0; row < dimension * dimension; row += 1) {
+        u64 *const planes = &this->planes[row * stride];
+        for (u32 x = 0; x < dimension; x += 1) {
+            CellState const state = this->cells[(row * dimension) + x];
+            u64 const       bit   = u64{1} << (x % 64U);
+            if (state == 0) {
+                continue;
+            }
+            planes[x / 64U] |= bit;
+            for (u32 p = 0; p < this->plane_count; p += 1) {
+                if (((state >> p) & 1U) != 0) {
+                    planes[((p + 1) * words) + (x / 64U)] |= bit;
+                }
+            }
+        }
+    }
+}
+
+void Life::recount() {
+    u32 const dimension = this->dimension;
+    u32 const area      = dimension * dimension;
+
+    for (auto &axis : this->live_counts) {
+        axis.fill(0);
+    }
+    for (u32 i = 0; i < this->size(); i += 1) {
+        if (this->cells[i] != 0) {
+            auto const [x, y, z] = this->reverse_idx(i);
+            this->live_counts[0][x] += 1;
+            this->live_counts[1][y] += 1;
+            this->live_counts[2][z] += 1;
+        }
+    }
+
+    std::ranges::fill(this->queued, 0);
+    std::ranges::fill(this->active, 0);
+    std::ranges::fill(this->next_active, 0);
+    for (u32 z = 0; z < this->stale_slabs.size(); z += 1) {
+        if (this->engine == LifeEngine::Counts) {
+            this->candidates[z].clear();
+            this->next_candidates[z].clear();
+        } else {
+            this->changes[z].clear();
+        }
+        this->flips[z].clear();
+    }
+    std::ranges::fill(this->stale_slabs, 1);
+    if (this->engine != LifeEngine::Counts) {
+        return;
+    }
+
+    // the live cells of each line along an axis summed over the three around
+    // each, along x, then y, then z, give the 3x3x3 around each cell
+    std::array<u8, MAX_AXIS> line{};
+    auto const               sum = [&](u32 first, u32 stride) {
+        for (u32 i = 0; i < dimension; i += 1) {
+            line[i] = this->counts[first + (i * stride)];
+        }
+        for (u32 i = 0; i < dimension; i += 1) {
+            this->counts[first + (i * stride)] = static_cast<u8>(
+                line[(i + dimension - 1) % dimension] + line[i] +
+                line[(i + 1) % dimension]
+            );
+        }
+    };
+    for (u32 i = 0; i < this->size(); i += 1) {
+        this->counts[i] = static_cast<u8>(this->cells[i] != 0);
+    }
+    for (u32 row = 0; row < area; row += 1) {
+        sum(row * dimension, 1);
+    }
+    for (u32 z = 0; z < dimension; z += 1) {
+        for (u32 x = 0; x < dimension; x += 1) {
+            sum((z * area) + x, dimension);
+        }
+    }
+    for (u32 i = 0; i < area; i += 1) {
+        sum(i, area);
+    }
+    // the cell itself is not its neighbour
+    for (u32 i = 0; i < this->size(); i += 1) {
+        this->counts[i] -= static_cast<u8>(this->cells[i] != 0);
+    }
+}
+
+void Life::load_rule(LifeRule const &rule) {
+    if (this->engine != LifeEngine::Counts &&
+        this->engine != LifeEngine::Frontier) {
+        return;
+    }
+    u32 born    = 0;
+    u32 survive = 0;
+    for (u8 count = 0; count < NEIGHBOURHOOD; count += 1) {
+        born |= static_cast<u32>(rule.dead_rule(count)) << count;
+        survive |= static_cast<u32>(rule.alive_rule(count)) << count;
+    }
+    auto const newborn = static_cast<CellState>(rule.state_count - 1);
+    if (born == this->born_mask && survive == this->survive_mask &&
+        newborn == this->newborn) {
+        return;
+    }
+    this->born_mask    = born;
+    this->survive_mask = survive;
+    this->newborn      = newborn;
+    // slabs already computed this generation are computed whole in the next
+    std::ranges::fill(this->stale_slabs, 1);
+}
+
+void Life::account_memory() {
+    usize pyramid = 0;
+    for (auto const &level : this->pyramid) {
+        pyramid += level.capacity();
+    }
+    // capacities, since shrinking keeps the storage
+    usize lists = 0;
+    for (auto const *slabs :
+         {&this->candidates, &this->next_candidates, &this->flips}) {
+        for (auto const &slab : *slabs) {
+            lists += slab.capacity() * sizeof(u32);
+        }
+    }
+    for (auto const &slab : this->changes) {
+        lists += slab.capacity() * sizeof(Change);
+    }
+    this->grid_memory.set(
+        this->cells.capacity() + pyramid +
+        (this->chunk_stamps.capacity() * sizeof(u64)) +
+        this->packed.capacity() + (this->planes.capacity() * sizeof(u64)) +
+        this->counts.capacity() + (this->active.capacity() * sizeof(u64))
+    );
+    this->scratch_memory.set(
+        this->next_cells.capacity() + this->next_touched.capacity() +
+        this->next_packed.capacity() +
+        (this->next_planes.capacity() * sizeof(u64)) +
+        this->queued.capacity() + this->stale_slabs.capacity() +
+        (this->next_active.capacity() * sizeof(u64)) + lists
+    );
+}
+
+auto Life::select_engine(u8 dimension, u8 state_count) -> LifeEngine {
+    if (preferred.has_value() &&
+        (preferred.value() != LifeEngine::Nibbles ||
+         state_count <= NIBBLE_STATES)) {
+        return preferred.value();
+    }
+    auto const size = static_cast<usize>(dimension) * dimension * dimension;
+    if (state_count <= NIBBLE_STATES &&
+        size + (2 * plane_bytes(dimension, state_count)) >
+            PLANES_MEMORY_LIMIT) {
+        return LifeEngine::Nibbles;
+    }
+    return LifeEngine::Planes;
+}
+
+void prefer_engine(LifeEngine engine) {
+    preferred = engine;
+}
+
+auto Life::estimate_view_memory(u8 dimension) -> LifeMemory {
+    auto const  size   = static_cast<usize>(dimension) * dimension * dimension;
+    usize const count  = (dimension + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    usize const chunks = count * count * count;
+
+    usize pyramid = 0;
+    for (u8 level = 1; level <= LOD_LEVELS; level += 1) {
+        usize const side = (dimension + (1U << level) - 1) >> level;
+        pyramid += side * side * side;
+    }
+    return {.grid = size + pyramid + (chunks * sizeof(u64)), .scratch = 0};
+}
+
+auto Life::estimate_memory(u8 dimension, u8 state_count) -> LifeMemory {
+    auto const  size   = static_cast<usize>(dimension) * dimension * dimension;
+    usize const count  = (dimension + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    usize const chunks = count * count * count;
+
+    // the grid the engine reads a generation from besides the cells, and
+    // the one it writes the next to
+    usize cells = size;
+    usize read  = 0;
+    usize write = size;
+    switch (select_engine(dimension, state_count)) {
+        case LifeEngine::Bytes:
+            break;
+        case LifeEngine::Nibbles:
+            // instead of the cells
+            cells = 0;
+            read  = size / 2;
+            write = size / 2;
+            break;
+        case LifeEngine::Planes:
+            read  = plane_bytes(dimension, state_count);
+            write = read;
+            break;
+        case LifeEngine::Counts:
+            // the counts, and whether each cell is a candidate, the lists of
+            // candidates growing with the cells that change
+            read = size;
+            break;
+        case LifeEngine::Frontier:
+            // a bit for each cell in the cells to compute, and in those of the
+            // next generation, the lists of changes growing with the cells that
+            // change
+            read  = (size + 63) / 64 * sizeof(u64);
+            write = read;
+            break;
+    }
+    return {
+        .grid    = estimate_view_memory(dimension).grid - size + cells + read,
+        .scratch = write + chunks,
+    };
+}
+
+void Life::touch_chunk(u8 x, u8 y, u8 z) {
+    u32 const cx  = x / CHUNK_SIZE;
+    u32 const cy  = y / CHUNK_SIZE;
+    u32 const cz  = z / CHUNK_SIZE;
+    u32 const idx = (((cz * this->chunk_count) + cy) * this->chunk_count) + cx;
+
+    // workers of the same generation may touch the same chunk
+    std::atomic_ref<u8> const touched(this->next_touched[idx]);
+    if (touched.load(std::memory_order_relaxed) == 0) {
+        touched.store(1, std::memory_order_relaxed);
+    }
+}
+
+void Life::touch_all() {
+    this->generation += 1;
+    std::ranges::fill(this->chunk_stamps, this->generation);
+    // a generation in progress was computed from the old cells
+    std::ranges::fill(this->next_touched, 0);
+    for (auto &live : this->next_live) {
+        live.fill(0);
+    }
+    this->next_slab = 0;
+}
+
+void Life::bound_live() {
+    LiveMarks live{};
+    for (u32 i = 0; i < this->size(); i += 1) {
+        if (this->load(i) != 0) {
+            auto const [x, y, z] = this->reverse_idx(i);
+            live[0][x]           = 1;
+            live[1][y]           = 1;
+            live[2][z]           = 1;
+        }
+    }
+    for (usize axis = 0; axis < 3; axis += 1) {
+        this->live_box[axis] = cover(live[axis], this->dimension);
+    }
+}
+
+void Life::mark_live(LiveMarks const &live) {
+    for (usize axis = 0; axis < 3; axis += 1) {
+        for (u32 i = 0; i < this->dimension; i += 1) {
+            if (live[axis][i] == 0) {
+                continue;
+            }
+            // workers of the same generation may mark the same coordinate
+            std::atomic_ref<u8> const marked(this->next_live[axis][i]);
+            if (marked.load(std::memory_order_relaxed) == 0) {
+                marked.store(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+auto Life::get_update_box(LifeRule const &rule) const -> LiveBox {
+    u32 const  dimension = this->dimension;
+    bool const spawns    = rule.dead_rule(0);
+    LiveBox    box{};
+    for (usize axis = 0; axis < 3; axis += 1) {
+        AxisRange const live = this->live_box[axis];
+        if (spawns || live.length + 2U >= dimension) {
+            box[axis] = {.first = 0, .length = static_cast<u16>(dimension)};
+        } else if (live.length != 0) {
+            u32 const first  = (live.first + dimension - 1) % dimension;
+            box[axis].first  = static_cast<u8>(first);
+            box[axis].length = static_cast<u16>(live.length + 2);
+        }
+    }
+    return box;
+}
+
+void Life::build_pyramid(u32 chunk) {
+    u32 const cx = chunk % this->chunk_count;
+    u32 const cy = (chunk / this->chunk_count) % this->chunk_count;
+    u32 const cz = (chunk / this->chunk_count) / this->chunk_count;
+
+    // chunks are aligned to every level, so each one is rebuilt on its own
+    for (u8 level = 1; level <= LOD_LEVELS; level += 1) {
+        auto const below      = this->get_level(level - 1);
+        u32 const  below_side = this->get_level_dimension(level - 1);
+        auto      &above      = this->pyramid[level - 1];
+        u32 const  side       = this->get_level_dimension(level);
+        u32 const  size       = CHUNK_SIZE >> level;
+
+        auto const child = [&](u32 x, u32 y, u32 z) -> CellState {
+            if (x >= below_side || y >= below_side || z >= below_side) {
+                return 0;
+            }
+            u32 const idx = (((z * below_side) + y) * below_side) + x;
+            // level 0 may be packed
+            return level == 1 ? this->load(idx) : below[idx];
+        };
+
+        u32 const x1 = std::min((cx + 1) * size, side);
+        u32 const y1 = std::min((cy + 1) * size, side);
+        u32 const z1 = std::min((cz + 1) * size, side);
+        for (u32 z = cz * size; z < z1; z += 1) {
+            for (u32 y = cy * size; y < y1; y += 1) {
+                for (u32 x = cx * size; x < x1; x += 1) {
+                    u32 const bx = x * 2;
+                    u32 const by = y * 2;
+                    u32 const bz = z * 2;
+                    above[(((z * side) + y) * side) + x] = dominant_state({
+                        child(bx, by, bz),
+                        child(bx + 1, by, bz),
+                        child(bx, by + 1, bz),
+                        child(bx + 1, by + 1, bz),
+                        child(bx, by, bz + 1),
+                        child(bx + 1, by, bz + 1),
+                        child(bx, by + 1, bz + 1),
+                        child(bx + 1, by + 1, bz + 1),
+                    });
+                }
+            }
+        }
+    }
+}
+
+void Life::build_pyramid() {
+    TraceZone const  zone("Life::build_pyramid");
+    std::vector<u32> dirty{};
+    for (u32 i = 0; i < this->chunk_stamps.size(); i += 1) {
+        if (this->chunk_stamps[i] == this->generation) {
+            dirty.push_back(i);
+        }
+    }
+
+    usize const thread_count = std::min<usize>(THREAD_COUNT, dirty.size());
+    std::atomic<usize>        next = 0;
+    std::vector<std::jthread> threads;
+    threads.reserve(thread_count);
+    for (usize t = 0; t < thread_count; t += 1) {
+        threads.emplace_back([this, &dirty, &next]() {
+            for (usize i = next++; i < dirty.size(); i = next++) {
+                this->build_pyramid(dirty[i]);
+            }
+        });
+    }
 }
 
 constexpr auto Life::get(u8 x, u8 y, u8 z) const -> CellState {
@@ -62,13 +575,37 @@ constexpr auto Life::get(u8 x, u8 y, u8 z) const -> CellState {
 
 auto Life::set(u8 x, u8 y, u8 z, CellState state) -> CellState {
     u32 const       idx = this->idx(x, y, z);
-    CellState const old = this->cells[idx];
-    this->cells[idx]    = state;
+    CellState const old = this->load(idx);
+    this->store(idx, state);
     return old;
 }
 
+constexpr auto Life::load(u32 idx) const -> CellState {
+    // only the Nibbles engine packs the cells, and never those of a view
+    if (this->packed.empty()) {
+        return this->cells[idx];
+    }
+    u8 const pair = this->packed[idx / 2];
+    return (idx % 2) == 0 ? pair & 0x0FU : pair >> 4U;
+}
+
+void Life::store(u32 idx, CellState state) {
+    if (this->packed.empty()) {
+        this->cells[idx] = state;
+        return;
+    }
+    u8 &pair = this->packed[idx / 2];
+    pair     = (idx % 2) == 0 ? static_cast<u8>((pair & 0xF0U) | state)
+                              : static_cast<u8>((pair & 0x0FU) | (state << 4U));
+}
+
 void Life::init_center_random(u8 state_count, f64 dead_chance) {
+    this->set_engine(
+        select_engine(this->dimension, state_count), count_planes(state_count)
+    );
     std::ranges::fill(this->cells, 0);
+    std::ranges::fill(this->packed, 0);
+    this->touch_all();
 
     u8 const lower = this->dimension >> 1U;
     u8 const upper = lower + 5;
@@ -80,38 +617,87 @@ void Life::init_center_random(u8 state_count, f64 dead_chance) {
             }
         }
     }
+    this->pack();
+    this->bound_live();
+    this->build_pyramid();
 }
 
 void Life::init_full_random(u8 state_count, f64 dead_chance) {
-    for (auto &cell : this->cells) {
-        cell = random_state(state_count, dead_chance);
+    this->set_engine(
+        select_engine(this->dimension, state_count), count_planes(state_count)
+    );
+    for (u32 i = 0; i < this->size(); i += 1) {
+        this->store(i, random_state(state_count, dead_chance));
     }
+    this->pack();
+    this->bound_live();
+    this->touch_all();
+    this->build_pyramid();
 }
 
-auto Life::draw(CellColorFn const &cell_color) const
-    -> std::array<std::vector<glm::vec3>, 2> {
-    std::vector<glm::vec3> points{};
-    std::vector<glm::vec3> colors{};
+auto Life::draw() const -> std::vector<u32> {
+    TraceZone const  zone("Life::draw");
+    std::vector<u32> points{};
 
-    points.reserve(this->size());
-    colors.reserve(this->size());
+    // cells outside the box are dead
+    auto const [xs, ys, zs] = this->live_box;
+    u32 const dimension     = this->dimension;
+    points.reserve(static_cast<usize>(xs.length) * ys.length * zs.length);
+    // the whole reserve, until the records are handed over
+    MemoryAccount const scratch(
+        Memory::Scratch, points.capacity() * sizeof(u32)
+    );
 
-    for (u32 i = 0; i < this->size(); i += 1) {
-        CellState const state = this->cells[i];
-        if (state == 0) {
-            continue;
+    for (u32 k = 0; k < zs.length; k += 1) {
+        auto const z = static_cast<u8>((zs.first + k) % dimension);
+        for (u32 j = 0; j < ys.length; j += 1) {
+            auto const y = static_cast<u8>((ys.first + j) % dimension);
+            for (u32 i = 0; i < xs.length; i += 1) {
+                auto const x = static_cast<u8>((xs.first + i) % dimension);
+                CellState const state = this->load(this->idx(x, y, z));
+                if (state != 0) {
+                    points.push_back(pack_cell(x, y, z, state));
+                }
+            }
         }
-        auto [x, y, z] = this->reverse_idx(i);
-        auto color =
-            cell_color(this->max_distance, this->dimension, state, x, y, z);
-        points.emplace_back(x, y, z);
-        colors.push_back(color);
     }
 
     points.shrink_to_fit();
-    colors.shrink_to_fit();
 
-    return {std::move(points), std::move(colors)};
+    return points;
+}
+
+void Life::copy_view_to(Life &view) const {
+    TraceZone const zone("Life::copy_view_to");
+    usize const size = this->size();
+    view.cells.resize(size);
+    if (this->packed.size() * 2 == size) {
+        for (u32 i = 0; i < this->packed.size(); i += 1) {
+            view.cells[2 * i]       = this->packed[i] & 0x0FU;
+            view.cells[(2 * i) + 1] = this->packed[i] >> 4U;
+        }
+    } else if (this->cells.size() == size) {
+        std::ranges::copy(this->cells, view.cells.begin());
+    } else {
+        // not initialised since it was made or resized, so all dead
+        std::ranges::fill(view.cells, 0);
+    }
+    view.pyramid      = this->pyramid;
+    view.chunk_stamps = this->chunk_stamps;
+    view.live_box     = this->live_box;
+    view.engine       = this->engine;
+    view.plane_count  = this->plane_count;
+    view.generation   = this->generation;
+    view.max_distance = this->max_distance;
+    view.dimension    = this->dimension;
+    view.chunk_count  = this->chunk_count;
+    view.account_memory();
+}
+
+auto Life::get_view() const -> Life {
+    Life view{};
+    this->copy_view_to(view);
+    return view;
 }
 
 [[clang::always_inline]] constexpr auto
@@ -123,9 +709,12 @@ Life::count_neighbours(u8 x, u8 y, u8 z) const -> u8 {
                 if (i == 0 && j == 0 && k == 0) {
                     continue;
                 }
-                u8 const xn = toroidal(static_cast<i8>(x + i), this->dimension);
-                u8 const yn = toroidal(static_cast<i8>(y + j), this->dimension);
-                u8 const zn = toroidal(static_cast<i8>(z + k), this->dimension);
+                u8 const xn =
+                    toroidal(static_cast<i16>(x + i), this->dimension);
+                u8 const yn =
+                    toroidal(static_cast<i16>(y + j), this->dimension);
+                u8 const zn =
+                    toroidal(static_cast<i16>(z + k), this->dimension);
                 live_neighbours += static_cast<u8>(this->get(xn, yn, zn) != 0);
             }
         }
@@ -133,43 +722,679 @@ Life::count_neighbours(u8 x, u8 y, u8 z) const -> u8 {
     return live_neighbours;
 }
 
-void Life::update_worker(
-    Life const &clone, LifeRule const &rule, u32 lower, u32 upper
+void Life::update_slabs(LifeRule const &rule, u8 lower, u8 upper) {
+    TraceZone const    zone("Life::update_slabs");
+    CounterScope const counters(
+        Phase::Update,
+        static_cast<u64>(upper - lower) * this->dimension * this->dimension
+    );
+    LiveBox const box = this->get_update_box(rule);
+    LiveMarks     live{};
+    switch (this->engine) {
+        case LifeEngine::Bytes:
+            this->update_byte_slabs(rule, box, lower, upper, live);
+            break;
+        case LifeEngine::Nibbles:
+            this->update_nibble_slabs(rule, box, lower, upper, live);
+            break;
+        case LifeEngine::Planes:
+            this->update_plane_slabs(rule, box, lower, upper, live);
+            break;
+        case LifeEngine::Counts:
+            // the live cells are counted at each coordinate as they flip
+            this->update_count_slabs(box, lower, upper);
+            break;
+        case LifeEngine::Frontier:
+            this->update_frontier_slabs(box, lower, upper);
+            break;
+    }
+    this->mark_live(live);
+}
+
+void Life::update_byte_slabs(
+    LifeRule const &rule,
+    LiveBox const  &box,
+    u8              lower,
+    u8              upper,
+    LiveMarks      &live
 ) {
-    for (u32 i = lower; i < upper; i += 1) {
+    for (u8 z = lower; z < upper; z += 1) {
+        for (u8 y = 0; y < this->dimension; y += 1) {
+            // cells outside the box are dead and stay so
+            CellState *const row = &this->next_cells[this->idx(0, y, z)];
+            std::fill_n(row, this->dimension, 0);
+            if (!contains(box[2], z, this->dimension) ||
+                !contains(box[1], y, this->dimension)) {
+                continue;
+            }
+            for (u32 k = 0; k < box[0].length; k += 1) {
+                auto const x =
+                    static_cast<u8>((box[0].first + k) % this->dimension);
+                u32 const       i     = this->idx(x, y, z);
+                CellState const state = this->cells[i];
+                CellState       next  = state;
+                if (state > 1) {
+                    next -= 1;
+                }
+                u8 const count = this->count_neighbours(x, y, z);
+                if (state == 0 && rule.dead_rule(count)) {
+                    next = rule.state_count - 1;
+                }
+                if (state == 1 && !rule.alive_rule(count)) {
+                    next = 0;
+                }
+                this->next_cells[i] = next;
+                if (next != state) {
+                    this->touch_chunk(x, y, z);
+                }
+                if (next != 0) {
+                    live[0][x] = 1;
+                    live[1][y] = 1;
+                    live[2][z] = 1;
+                }
+            }
+        }
+    }
+}
+
+void Life::update_nibble_slabs(
+    LifeRule const &rule,
+    LiveBox const  &box,
+    u8              lower,
+    u8              upper,
+    LiveMarks      &live
+) {
+    u32 const dimension = this->dimension;
+    u32 const width     = dimension / 2;
+
+    // the rule for every count, rather than two calls per cell
+    std::array<bool, NEIGHBOURHOOD> born{};
+    std::array<bool, NEIGHBOURHOOD> survives{};
+    for (u8 count = 0; count < NEIGHBOURHOOD; count += 1) {
+        born[count]     = rule.dead_rule(count);
+        survives[count] = rule.alive_rule(count);
+    }
+    auto const newborn = static_cast<CellState>(rule.state_count - 1);
+
+    // live cells of the 3x3 rows around a row, summed over each column, with
+    // the last column repeated before the first and the first after the
+    // last, so a cell counts the columns x to x + 2 without wrapping
+    std::array<u8, MAX_AXIS + 2>    columns{};
+    std::array<CellState, MAX_AXIS> states{};
+    std::array<CellState, MAX_AXIS> next{};
+    std::array<u32, 3> const       offsets = {dimension - 1, 0, 1};
+
+    // the loops over a row unpack or pack a byte per step with no branches,
+    // which compilers turn into vector shifts, masks and compares
+    for (u32 z = lower; z < upper; z += 1) {
+        for (u32 y = 0; y < dimension; y += 1) {
+            u32 const first = ((z * dimension) + y) * dimension;
+            // rows outside the box are dead and stay so
+            if (!contains(box[2], z, dimension) ||
+                !contains(box[1], y, dimension)) {
+                std::fill_n(&this->next_packed[first / 2], width, 0);
+                continue;
+            }
+
+            std::fill_n(columns.begin(), dimension + 2, 0);
+            for (u32 const dz : offsets) {
+                for (u32 const dy : offsets) {
+                    u32 const zn  = (z + dz) % dimension;
+                    u32 const yn  = (y + dy) % dimension;
+                    u8 const *row = &this->packed
+                        [(((zn * dimension) + yn) * dimension) / 2];
+                    for (u32 k = 0; k < width; k += 1) {
+                        columns[(2 * k) + 1] +=
+                            static_cast<u8>((row[k] & 0x0FU) != 0);
+                        columns[(2 * k) + 2] +=
+                            static_cast<u8>((row[k] >> 4U) != 0);
+                    }
+                }
+            }
+            columns[0]             = columns[dimension];
+            columns[dimension + 1] = columns[1];
+
+            u8 const *row = &this->packed[first / 2];
+            for (u32 k = 0; k < width; k += 1) {
+                states[2 * k]       = row[k] & 0x0FU;
+                states[(2 * k) + 1] = row[k] >> 4U;
+            }
+
+            u8 alive = 0;
+            for (u32 x = 0; x < dimension; x += 1) {
+                CellState const state = states[x];
+                u8 const        count = columns[x] + columns[x + 1] +
+                                 columns[x + 2] -
+                                 static_cast<u8>(state != 0);
+                CellState cell = state > 1 ? state - 1 : state;
+                if (state == 0 && born[count]) {
+                    cell = newborn;
+                }
+                if (state == 1 && !survives[count]) {
+                    cell = 0;
+                }
+                next[x] = cell;
+                live[0][x] |= static_cast<u8>(cell != 0);
+                alive |= cell;
+            }
+            if (alive != 0) {
+                live[1][y] = 1;
+                live[2][z] = 1;
+            }
+
+            u8 *const next_row = &this->next_packed[first / 2];
+            for (u32 k = 0; k < width; k += 1) {
+                next_row[k] =
+                    static_cast<u8>(next[2 * k] | (next[(2 * k) + 1] << 4U));
+            }
+            for (u32 x = 0; x < dimension; x += 1) {
+                if (next[x] != states[x]) {
+                    this->touch_chunk(
+                        static_cast<u8>(x),
+                        static_cast<u8>(y),
+                        static_cast<u8>(z)
+                    );
+                }
+            }
+        }
+    }
+}
+
+void Life::update_plane_slabs(
+    LifeRule const &rule,
+    LiveBox const  &box,
+    u8              lower,
+    u8              upper,
+    LiveMarks      &live
+) {
+    using Row = std::array<u64, MAX_ROW_WORDS>;
+
+    u32 const dimension = this->dimension;
+    u32 const words     = this->get_row_words();
+    u32 const stride    = (this->plane_count + 1U) * words;
+    u32 const last      = (dimension - 1) % 64U;
+    // bits of the last word of a row that hold cells
+    u64 const last_mask = last == 63 ? ~u64{0} : (u64{2} << last) - 1;
+
+    // counts the rule gives birth and keeps alive at
+    std::array<u8, NEIGHBOURHOOD> born{};
+    std::array<u8, NEIGHBOURHOOD> survives{};
+    usize                         born_count    = 0;
+    usize                         survive_count = 0;
+    for (u8 count = 0; count < NEIGHBOURHOOD; count += 1) {
+        if (rule.dead_rule(count)) {
+            born[born_count++] = count;
+        }
+        if (rule.alive_rule(count)) {
+            survives[survive_count++] = count;
+        }
+    }
+    auto const newborn = static_cast<u32>(rule.state_count - 1);
+
+    std::array<u32, 3> const offsets = {dimension - 1, 0, 1};
+    // x of the live cells of the next generation, as bits of a row
+    Row                      columns{};
+    for (u32 z = lower; z < upper; z += 1) {
+        for (u32 y = 0; y < dimension; y += 1) {
+            u32 const  first = ((z * dimension) + y) * dimension;
+            u64 const *state = &this->planes[(first / dimension) * stride];
+            u64 *const next  = &this->next_planes[(first / dimension) * stride];
+            // rows outside the box are dead and stay so
+            if (!contains(box[2], z, dimension) ||
+                !contains(box[1], y, dimension)) {
+                std::fill_n(next, stride, 0);
+                continue;
+            }
+
+            // live neighbours of the cells of the row, bit b of each count
+            // in counts[b], summed 64 cells at a time by ripple carry
+            std::array<Row, COUNT_BITS> counts{};
+            auto const add = [&](Row const &bits) {
+                for (u32 w = 0; w < words; w += 1) {
+                    u64 carry = bits[w];
+                    for (Row &count : counts) {
+                        u64 const next = count[w] & carry;
+                        count[w] ^= carry;
+                        carry = next;
+                    }
+                }
+            };
+            for (u32 const dz : offsets) {
+                for (u32 const dy : offsets) {
+                    u32 const  zn    = (z + dz) % dimension;
+                    u32 const  yn    = (y + dy) % dimension;
+                    u64 const *alive = &this->planes
+                        [((zn * dimension) + yn) * stride];
+
+                    // west[x] is row[x - 1] and east[x] is row[x + 1], the
+                    // ends of the row wrapping around to each other
+                    Row row{};
+                    Row west{};
+                    Row east{};
+                    std::copy_n(alive, words, row.begin());
+                    for (u32 w = 0; w < words; w += 1) {
+                        west[w] = (row[w] << 1U) |
+                                  (w == 0 ? (row[words - 1] >> last) & 1U
+                                          : row[w - 1] >> 63U);
+                        east[w] = (row[w] >> 1U) |
+                                  (w + 1 < words ? row[w + 1] << 63U : 0);
+                    }
+                    west[words - 1] &= last_mask;
+                    east[words - 1] |= (row[0] & 1U) << last;
+
+                    add(west);
+                    add(east);
+                    if (dz != 0 || dy != 0) {
+                        add(row);
+                    }
+                }
+            }
+
+            u64 alive_row = 0;
+            for (u32 w = 0; w < words; w += 1) {
+                auto const equals = [&](u8 count) -> u64 {
+                    u64 match = ~u64{0};
+                    for (u32 b = 0; b < COUNT_BITS; b += 1) {
+                        match &= ((count >> b) & 1U) != 0 ? counts[b][w]
+                                                          : ~counts[b][w];
+                    }
+                    return match;
+                };
+                u64 birth = 0;
+                for (usize i = 0; i < born_count; i += 1) {
+                    birth |= equals(born[i]);
+                }
+                u64 keep = 0;
+                for (usize i = 0; i < survive_count; i += 1) {
+                    keep |= equals(survives[i]);
+                }
+
+                u64 const alive  = state[w];
+                u64       higher = 0;
+                for (u32 p = 1; p < this->plane_count; p += 1) {
+                    higher |= state[((p + 1) * words) + w];
+                }
+                u64 const mask   = w + 1 == words ? last_mask : ~u64{0};
+                u64 const one    = alive & ~higher;
+                u64 const decays = alive & ~one;
+                u64 const kept   = one & keep;
+                u64 const births = ~alive & birth & mask;
+
+                // decaying cells take state - 1, by a bit-sliced subtract
+                u64 borrow     = ~u64{0};
+                u64 next_alive = 0;
+                u64 changed    = 0;
+                for (u32 p = 0; p < this->plane_count; p += 1) {
+                    u64 const bit         = state[((p + 1) * words) + w];
+                    u64 const decremented = bit ^ borrow;
+                    borrow &= ~bit;
+                    u64 const result = (decays & decremented) | (kept & bit) |
+                                       (((newborn >> p) & 1U) != 0 ? births
+                                                                   : 0);
+                    next[((p + 1) * words) + w] = result;
+                    next_alive |= result;
+                    changed |= result ^ bit;
+                }
+                next[w] = next_alive;
+                columns[w] |= next_alive;
+                alive_row |= next_alive;
+
+                // cells still hold this generation, so only changes are
+                // written
+                while (changed != 0) {
+                    auto const bit =
+                        static_cast<u32>(std::countr_zero(changed));
+                    changed &= changed - 1;
+                    CellState cell = 0;
+                    for (u32 p = 0; p < this->plane_count; p += 1) {
+                        cell |= static_cast<CellState>(
+                            ((next[((p + 1) * words) + w] >> bit) & 1U) << p
+                        );
+                    }
+                    u32 const x            = (w * 64U) + bit;
+                    this->cells[first + x] = cell;
+                    this->touch_chunk(
+                        static_cast<u8>(x),
+                        static_cast<u8>(y),
+                        static_cast<u8>(z)
+                    );
+                }
+            }
+            if (alive_row != 0) {
+                live[1][y] = 1;
+                live[2][z] = 1;
+            }
+        }
+    }
+    for (u32 x = 0; x < dimension; x += 1) {
+        live[0][x] = static_cast<u8>((columns[x / 64U] >> (x % 64U)) & 1U);
+    }
+}
+
+template <typename Visit>
+void Life::for_box(LiveBox const &box, u32 z, Visit const &visit) const {
+    u32 const dimension = this->dimension;
+    if (!contains(box[2], z, dimension)) {
+        return;
+    }
+    for (u32 y = 0; y < dimension; y += 1) {
+        if (!contains(box[1], y, dimension)) {
+            continue;
+        }
+        for (u32 k = 0; k < box[0].length; k += 1) {
+            u32 const x = (box[0].first + k) % dimension;
+            visit((((z * dimension) + y) * dimension) + x);
+        }
+    }
+}
+
+void Life::update_count_slabs(LiveBox const &box, u8 lower, u8 upper) {
+    u32 const area = this->dimension * this->dimension;
+
+    // cells still hold this generation where they do not change, and no
+    // cell reads another, so the changes are written in place
+    auto const compute = [this](u32 z, u32 i) {
         CellState const state = this->cells[i];
-        if (state > 1) {
-            this->cells[i] -= 1;
+        u8 const        count = this->counts[i];
+        CellState       next  = state > 1 ? state - 1 : state;
+        if (state == 0 && ((this->born_mask >> count) & 1U) != 0) {
+            next = this->newborn;
         }
-        auto [x, y, z] = this->reverse_idx(i);
-        u8 const count = clone.count_neighbours(x, y, z);
-        if (state == 0 && rule.dead_rule(count)) {
-            this->cells[i] = rule.state_count - 1;
+        if (state == 1 && ((this->survive_mask >> count) & 1U) == 0) {
+            next = 0;
         }
-        if (state == 1 && !rule.alive_rule(count)) {
-            this->cells[i] = 0;
+        if (next == state) {
+            return;
         }
+        this->cells[i] = next;
+        auto const [x, y, cz] = this->reverse_idx(i);
+        this->touch_chunk(x, y, cz);
+        // it was just taken off the candidates, so is not queued
+        this->queued[i] = 1;
+        this->next_candidates[z].push_back(i);
+        if ((state == 0) != (next == 0)) {
+            this->flips[z].push_back(i);
+        }
+    };
+
+    // a slab is only ever computed by one worker, which owns its lists and
+    // the queued flags of its cells until every slab is computed
+    for (u32 z = lower; z < upper; z += 1) {
+        std::vector<u32> &candidates = this->candidates[z];
+        if (this->stale_slabs[z] != 0) {
+            this->stale_slabs[z] = 0;
+            std::fill_n(&this->queued[z * area], area, 0);
+            candidates.clear();
+            this->for_box(box, z, [&](u32 i) { compute(z, i); });
+            continue;
+        }
+        for (u32 const i : candidates) {
+            this->queued[i] = 0;
+            compute(z, i);
+        }
+        candidates.clear();
     }
 }
 
-void Life::update(LifeRule const &rule) {
-    static Life life_clone = Life(0);
+void Life::update_frontier_slabs(LiveBox const &box, u8 lower, u8 upper) {
+    u32 const area = this->dimension * this->dimension;
 
-    life_clone = *this;
+    // queues a cell for the next generation, once however many of its
+    // neighbours change, and whichever workers compute them
+    auto const queue = [this](u32 i) {
+        std::atomic_ref<u64> const word(this->next_active[i / 64]);
+        u64 const                  bit = u64{1} << (i % 64);
+        if ((word.load(std::memory_order_relaxed) & bit) == 0) {
+            word.fetch_or(bit, std::memory_order_relaxed);
+        }
+    };
+    // cells are read around every cell computed, so the changes wait in
+    // the lists of the slab until every slab is computed
+    auto const compute = [&](u32 z, u32 i) {
+        auto const [x, y, cz] = this->reverse_idx(i);
+        CellState const state = this->cells[i];
+        u8 const        count = this->count_neighbours(x, y, cz);
+        CellState       next  = state > 1 ? state - 1 : state;
+        if (state == 0 && ((this->born_mask >> count) & 1U) != 0) {
+            next = this->newborn;
+        }
+        if (state == 1 && ((this->survive_mask >> count) & 1U) == 0) {
+            next = 0;
+        }
+        if (next == state) {
+            return;
+        }
+        this->changes[z].push_back({.index = i, .state = next});
+        this->touch_chunk(x, y, cz);
+        if ((state == 0) != (next == 0)) {
+            this->flips[z].push_back(i);
+        }
+        // the cells that changed include every one decaying, so those are
+        // computed again along with the cells around them
+        for (i8 k = -1; k <= 1; k += 1) {
+            u8 const zn = toroidal(static_cast<i16>(cz + k), this->dimension);
+            for (i8 j = -1; j <= 1; j += 1) {
+                u8 const yn =
+                    toroidal(static_cast<i16>(y + j), this->dimension);
+                for (i8 h = -1; h <= 1; h += 1) {
+                    u8 const xn =
+                        toroidal(static_cast<i16>(x + h), this->dimension);
+                    queue(this->idx(xn, yn, zn));
+                }
+            }
+        }
+    };
+
+    for (u32 z = lower; z < upper; z += 1) {
+        u32 const first = z * area;
+        u32 const last  = first + area;
+        if (this->stale_slabs[z] != 0) {
+            this->stale_slabs[z] = 0;
+            this->for_box(box, z, [&](u32 i) { compute(z, i); });
+            continue;
+        }
+        // the words at either end of a slab may hold cells of the slabs
+        // next to it, another worker's to compute
+        for (u32 w = first / 64; w * 64 < last; w += 1) {
+            u64 bits = this->active[w];
+            if (w * 64 < first) {
+                bits &= ~u64{0} << (first % 64);
+            }
+            if ((w + 1) * 64 > last) {
+                bits &= (u64{1} << (last % 64)) - 1;
+            }
+            while (bits != 0) {
+                auto const bit = static_cast<u32>(std::countr_zero(bits));
+                bits &= bits - 1;
+                compute(z, (w * 64) + bit);
+            }
+        }
+    }
+}
 
-    u32 const increment = this->size() / THREAD_COUNT;
-    u32       lower     = 0;
-    u32       upper     = increment;
+void Life::settle_slabs(u8 lower, u8 upper) {
+    switch (this->engine) {
+        case LifeEngine::Counts:
+            this->count_flips(lower, upper);
+            break;
+        case LifeEngine::Frontier:
+            this->apply_changes(lower, upper);
+            break;
+        default:
+            break;
+    }
+}
 
-    std::array<std::jthread, THREAD_COUNT> threads;
+void Life::count_flips(u8 lower, u8 upper) {
+    TraceZone const zone("Life::count_flips");
+    u32 const       dimension = this->dimension;
+    // the flips of the slab on either side reach into the slabs too
+    u32 const       slabs     = std::min<u32>(upper - lower + 2U, dimension);
 
-    for (auto &thrd : threads) {
-        thrd  = std::jthread([this, rule, lower, upper]() {
-            this->update_worker(life_clone, rule, lower, upper);
+    for (u32 k = 0; k < slabs; k += 1) {
+        u32 const slab = (lower + dimension - 1 + k) % dimension;
+        for (u32 const i : this->flips[slab]) {
+            auto const [x, y, z] = this->reverse_idx(i);
+            i32 const delta      = this->cells[i] != 0 ? 1 : -1;
+            for (i8 dz = -1; dz <= 1; dz += 1) {
+                u8 const zn = toroidal(static_cast<i16>(z + dz), dimension);
+                // only the slabs given are written, so workers never meet
+                if (zn < lower || zn >= upper) {
+                    continue;
+                }
+                for (i8 dy = -1; dy <= 1; dy += 1) {
+                    u8 const yn = toroidal(static_cast<i16>(y + dy), dimension);
+                    for (i8 dx = -1; dx <= 1; dx += 1) {
+                        if (dx == 0 && dy == 0 && dz == 0) {
+                            continue;
+                        }
+                        u8 const xn =
+                            toroidal(static_cast<i16>(x + dx), dimension);
+                        u32 const n = this->idx(xn, yn, zn);
+                        this->counts[n] =
+                            static_cast<u8>(this->counts[n] + delta);
+                        if (this->queued[n] == 0) {
+                            this->queued[n] = 1;
+                            this->next_candidates[zn].push_back(n);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Life::apply_changes(u8 lower, u8 upper) {
+    TraceZone const zone("Life::apply_changes");
+    for (u32 z = lower; z < upper; z += 1) {
+        for (Change const &change : this->changes[z]) {
+            this->cells[change.index] = change.state;
+        }
+        this->changes[z].clear();
+    }
+
+    // clears the cells computed for the next generation to queue into, a
+    // word belonging to the slab of its first cell so workers never share
+    // one
+    u32 const area  = this->dimension * this->dimension;
+    u32 const first = ((lower * area) + 63) / 64;
+    u32 const last  = ((upper * area) + 63) / 64;
+    std::fill(&this->active[first], &this->active[last], 0);
+}
+
+void Life::count_live() {
+    for (std::vector<u32> &flips : this->flips) {
+        for (u32 const i : flips) {
+            auto const [x, y, z] = this->reverse_idx(i);
+            // one more where a cell was born, one less, by wrapping around,
+            // where one died
+            u32 const delta      = this->cells[i] != 0 ? 1U : ~0U;
+            this->live_counts[0][x] += delta;
+            this->live_counts[1][y] += delta;
+            this->live_counts[2][z] += delta;
+        }
+        flips.clear();
+    }
+    for (usize axis = 0; axis < 3; axis += 1) {
+        for (u32 i = 0; i < this->dimension; i += 1) {
+            this->next_live[axis][i] =
+                static_cast<u8>(this->live_counts[axis][i] != 0);
+        }
+    }
+    // the lists grow with the cells that change
+    this->account_memory();
+}
+
+void Life::finish_update() {
+    TraceZone const    zone("Life::finish_update");
+    CounterScope const counters(Phase::Update, 0);
+    switch (this->engine) {
+        case LifeEngine::Bytes:
+            this->cells.swap(this->next_cells);
+            break;
+        case LifeEngine::Nibbles:
+            this->packed.swap(this->next_packed);
+            break;
+        case LifeEngine::Planes:
+            this->planes.swap(this->next_planes);
+            break;
+        case LifeEngine::Counts:
+            this->candidates.swap(this->next_candidates);
+            this->count_live();
+            break;
+        case LifeEngine::Frontier:
+            this->active.swap(this->next_active);
+            this->count_live();
+            break;
+    }
+    for (usize axis = 0; axis < 3; axis += 1) {
+        this->live_box[axis] = cover(this->next_live[axis], this->dimension);
+        this->next_live[axis].fill(0);
+    }
+    this->next_slab = 0;
+
+    this->generation += 1;
+    for (u32 i = 0; i < this->next_touched.size(); i += 1) {
+        if (this->next_touched[i] != 0) {
+            this->chunk_stamps[i] = this->generation;
+            this->next_touched[i] = 0;
+        }
+    }
+
+    this->build_pyramid();
+}
+
+void Life::update(LifeRule const &rule) {
+    TraceZone const zone("Life::update");
+    this->load_rule(rule);
+
+    // runs work on the slabs from lower on, split between the threads
+    auto const split = [this](u32 lower, auto const &work) {
+        u32 const remaining = this->dimension - lower;
+
+        std::array<std::jthread, THREAD_COUNT> threads;
+        for (u32 t = 0; t < THREAD_COUNT; t += 1) {
+            auto const first = static_cast<u8>(
+                lower + ((remaining * t) / THREAD_COUNT)
+            );
+            auto const last = static_cast<u8>(
+                lower + ((remaining * (t + 1)) / THREAD_COUNT)
+            );
+            threads[t] = std::jthread([&work, first, last]() {
+                set_trace_thread_name("update worker");
+                work(first, last);
+            });
+        }
+    };
+
+    // the slabs advance has not computed yet
+    split(this->next_slab, [this, &rule](u8 first, u8 last) {
+        this->update_slabs(rule, first, last);
+    });
+    if (this->engine == LifeEngine::Counts ||
+        this->engine == LifeEngine::Frontier) {
+        split(0, [this](u8 first, u8 last) {
+            this->settle_slabs(first, last);
         });
-        lower = upper;
-        upper += increment;
     }
+
+    this->finish_update();
+}
+
+auto Life::advance(LifeRule const &rule, u8 slabs) -> bool {
+    u8 const upper = static_cast<u8>(
+        std::min<u32>(this->next_slab + slabs, this->dimension)
+    );
+    this->load_rule(rule);
+    this->update_slabs(rule, this->next_slab, upper);
+    this->next_slab = upper;
+
+    if (this->next_slab < this->dimension) {
+        return false;
+    }
+    this->settle_slabs(0, this->dimension);
+    this->finish_update();
+    return true;
 }
 
 constexpr auto Life::idx(u8 x, u8 y, u8 z) const -> u32 {
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cell/counters.hpp>
+#include <cell/stats.hpp>
+#include <util/util.hpp>
+
+namespace cell {
+
+CounterSample::CounterSample(
+    std::array<u64, COUNTER_COUNT> counts, u8 counted, u64 cells
+)
+    : counts(counts), counted(counted), cells(cells) {
+}
+
+void CounterSample::merge(CounterSample const &other) {
+    for (usize i = 0; i < COUNTER_COUNT; i += 1) {
+        this->counts[i] += other.counts[i];
+    }
+    this->counted |= other.counted;
+    this->cells += other.cells;
+}
+
+namespace {
+auto ratio(u64 numerator, u64 denominator) -> f64 {
+    if (denominator == 0) {
+        return 0.0;
+    }
+    return static_cast<f64>(numerator) / static_cast<f64>(denominator);
+}
+} // namespace
+
+auto CounterSample::get_ipc() const -> f64 {
+    if (!this->has(Counter::Instructions)) {
+        return 0.0;
+    }
+    return ratio(this->get(Counter::Instructions), this->get(Counter::Cycles));
+}
+
+auto CounterSample::get_cycles_per_cell() const -> f64 {
+    return ratio(this->get(Counter::Cycles), this->cells);
+}
+
+auto CounterSample::get_bytes_per_cell() const -> f64 {
+    return ratio(
+        this->get(Counter::CacheMisses) * CACHE_LINE_SIZE, this->cells
+    );
+}
+
+auto CounterSample::get_stalled() const -> f64 {
+    return ratio(this->get(Counter::StalledCycles), this->get(Counter::Cycles));
+}
+
+namespace {
+std::atomic<bool> counting = false;
+// counters the machine supports, found by start_counters
+u8                supported{};
+
+std::mutex                             mutex;
+std::array<CounterSample, PHASE_COUNT> samples{};
+
+#ifdef __linux__
+constexpr std::array<u64, COUNTER_COUNT> EVENTS = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_STALLED_CYCLES_BACKEND,
+};
+
+// Opens a counter of the calling thread in user space, as the leader of a
+// new group if group is -1. Returns -1 and sets errno on failure.
+auto open_counter(Counter counter, i32 group) -> i32 {
+    perf_event_attr attr{};
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = EVENTS[static_cast<usize>(counter)];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                          PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<i32>(
+        syscall(SYS_perf_event_open, &attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC)
+    );
+}
+
+// Counters of one thread, in a group so the kernel schedules them together
+// and they are read at once.
+class CounterGroup {
+    std::array<i32, COUNTER_COUNT> fds{-1, -1, -1, -1};
+    u8                             counted{};
+
+  public:
+    // Opens the counters of mask on the calling thread.
+    explicit CounterGroup(u8 mask) {
+        for (usize i = 0; i < COUNTER_COUNT; i += 1) {
+            if ((mask & (1U << i)) == 0) {
+                continue;
+            }
+            this->fds[i] = open_counter(static_cast<Counter>(i), this->fds[0]);
+            if (this->fds[i] >= 0) {
+                this->counted |= static_cast<u8>(1U << i);
+            } else if (i == 0) {
+                // nothing counts without the leader
+                return;
+            }
+        }
+        ioctl(this->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(this->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    ~CounterGroup() {
+        for (i32 const fd : this->fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    CounterGroup(CounterGroup const &)                     = delete;
+    CounterGroup(CounterGroup &&)                          = delete;
+    auto operator=(CounterGroup const &) -> CounterGroup & = delete;
+    auto operator=(CounterGroup &&) -> CounterGroup &      = delete;
+
+    [[nodiscard]] constexpr auto get_counted() const -> u8 {
+        return this->counted;
+    }
+
+    // Counts since the group was opened, scaled up for the time the kernel
+    // had the group off the PMU to count others.
+    [[nodiscard]] auto read() const -> std::array<u64, COUNTER_COUNT> {
+        std::array<u64, COUNTER_COUNT> counts{};
+        if (this->counted == 0) {
+            return counts;
+        }
+
+        // nr, time enabled, time running, then the counts of the group in
+        // the order the counters were opened
+        std::array<u64, 3 + COUNTER_COUNT> buffer{};
+        if (::read(this->fds[0], buffer.data(), sizeof(buffer)) <= 0) {
+            return counts;
+        }
+        f64 const scale = buffer[2] == 0 ? 0.0
+                                         : static_cast<f64>(buffer[1]) /
+                                               static_cast<f64>(buffer[2]);
+        usize next = 3;
+        for (usize i = 0; i < COUNTER_COUNT; i += 1) {
+            if ((this->counted & (1U << i)) != 0) {
+                counts[i] =
+                    static_cast<u64>(static_cast<f64>(buffer[next]) * scale);
+                next += 1;
+            }
+        }
+        return counts;
+    }
+};
+
+auto thread_group() -> CounterGroup const & {
+    thread_local CounterGroup const group(supported);
+    return group;
+}
+#endif
+} // namespace
+
+void start_counters() {
+#ifdef __linux__
+    errno = 0;
+    CounterGroup const probe(0b1111);
+    if (probe.get_counted() == 0) {
+        eprintln(
+            "counters: unavailable, {}{}",
+            std::strerror(errno),
+            errno == EACCES || errno == EPERM
+                ? ", see /proc/sys/kernel/perf_event_paranoid"
+                : ""
+        );
+        return;
+    }
+
+    std::string names{};
+    std::string missing{};
+    for (usize i = 0; i < COUNTER_COUNT; i += 1) {
+        std::string &list =
+            (probe.get_counted() & (1U << i)) != 0 ? names : missing;
+        list += list.empty() ? "" : ", ";
+        list += COUNTER_NAMES[i];
+    }
+    if (missing.empty()) {
+        eprintln("counters: {}", names);
+    } else {
+        eprintln("counters: {}, without {}", names, missing);
+    }
+
+    supported = probe.get_counted();
+    counting.store(true, std::memory_order_release);
+#else
+    eprintln("counters: unavailable, perf_event_open is Linux only");
+#endif
+}
+
+auto is_counting() -> bool {
+    return counting.load(std::memory_order_acquire);
+}
+
+auto take_counters(Phase phase) -> CounterSample {
+    std::scoped_lock const lock(mutex);
+    return std::exchange(samples[static_cast<usize>(phase)], CounterSample{});
+}
+
+CounterScope::CounterScope(Phase phase, u64 cells)
+    : phase(phase), cells(cells), active(is_counting()) {
+#ifdef __linux__
+    if (this->active) {
+        this->start = thread_group().read();
+    }
+#endif
+}
+
+CounterScope::~CounterScope() {
+#ifdef __linux__
+    if (!this->active) {
+        return;
+    }
+    CounterGroup const            &group = thread_group();
+    std::array<u64, COUNTER_COUNT> counts = group.read();
+    for (usize i = 0; i < COUNTER_COUNT; i += 1) {
+        counts[i] -= std::min(counts[i], this->start[i]);
+    }
+
+    std::scoped_lock const lock(mutex);
+    samples[static_cast<usize>(this->phase)].merge(
+        CounterSample(counts, group.get_counted(), this->cells)
+    );
+#endif
+}
+
+} // namespace cell
@@ -0,0 +1,108 @@
+#include <algorithm>
+
+#include <cell/governor.hpp>
+#include <util/util.hpp>
+
+namespace cell {
+
+namespace {
+// frames over this fraction of the target are too slow, frames under the
+// second one leave room to restore quality
+constexpr f64 OVER_TARGET  = 1.1;
+constexpr f64 UNDER_TARGET = 0.75;
+
+// smallest budget given to the simulation, so it never stops entirely
+constexpr f64 MIN_UPDATE_BUDGET = 0.001;
+} // namespace
+
+Governor::Governor(f64 target) : target(target) {}
+
+void Governor::measure(f64 draw_time, f64 update_time) {
+    this->frames += 1;
+    this->draw_time += draw_time;
+    this->update_time += update_time;
+    if (this->frames == GOVERNOR_INTERVAL) {
+        this->adjust();
+    }
+}
+
+void Governor::measure_gpu(f64 seconds) {
+    this->gpu_frames += 1;
+    this->gpu_time += seconds;
+}
+
+void Governor::adjust() {
+    f64 const frames = static_cast<f64>(this->frames);
+    f64 const cpu    = (this->draw_time + this->update_time) / frames;
+    f64 const gpu =
+        this->gpu_time / static_cast<f64>(std::max<u32>(this->gpu_frames, 1));
+    f64 const frame = std::max(cpu, gpu);
+
+    this->draw_average = this->draw_time / frames;
+    this->frames       = 0;
+    this->draw_time    = 0.0;
+    this->update_time  = 0.0;
+    this->gpu_frames   = 0;
+    this->gpu_time     = 0.0;
+    if (!this->enabled) {
+        return;
+    }
+
+    f32 const render_scale = this->render_scale;
+    f32 const lod_bias     = this->lod_bias;
+    u8 const  throttle     = this->throttle;
+    if (frame > this->target * OVER_TARGET) {
+        if (gpu >= cpu && this->render_scale > MIN_RENDER_SCALE) {
+            this->render_scale = std::max(
+                this->render_scale - RENDER_SCALE_STEP, MIN_RENDER_SCALE
+            );
+        } else if (gpu < cpu && this->throttle < MAX_THROTTLE) {
+            this->throttle += 1;
+        } else if (this->lod_bias < MAX_GOVERNOR_LOD_BIAS) {
+            this->lod_bias += 1.0F;
+        }
+    } else if (frame < this->target * UNDER_TARGET) {
+        if (this->lod_bias > 0.0F) {
+            this->lod_bias -= 1.0F;
+        } else if (this->throttle > 0) {
+            this->throttle -= 1;
+        } else if (this->render_scale < 1.0F) {
+            this->render_scale =
+                std::min(this->render_scale + RENDER_SCALE_STEP, 1.0F);
+        }
+    }
+
+    if (render_scale != this->render_scale || lod_bias != this->lod_bias ||
+        throttle != this->throttle) {
+        eprintln(
+            "governor: cpu {} ms, gpu {} ms, scale {}, lod bias {}, "
+            "throttle {}",
+            cpu * 1000.0,
+            gpu * 1000.0,
+            this->render_scale,
+            this->lod_bias,
+            this->throttle
+        );
+    }
+}
+
+auto Governor::get_update_budget(f64 limit) const -> f64 {
+    if (!this->enabled) {
+        return limit;
+    }
+    // the GPU draws while the CPU simulates, so only preparing the draw
+    // competes with the simulation
+    f64 const slack = this->target - this->draw_average;
+    return std::clamp(slack, std::min(MIN_UPDATE_BUDGET, limit), limit);
+}
+
+void Governor::set_enabled(bool enabled) {
+    this->enabled = enabled;
+    if (!enabled) {
+        this->render_scale = 1.0F;
+        this->lod_bias     = 0.0F;
+        this->throttle     = 0;
+    }
+}
+
+} // namespace cell
@@ -0,0 +1,121 @@
+#include <chrono>
+
+#include <cell/gpu_timer.hpp>
+
+namespace cell {
+
+auto GpuTimers::collect(Stats &stats) -> std::optional<f64> {
+    Frame const &frame = this->frames[this->collected % GPU_QUERY_DEPTH];
+    // the end of the frame is its last timestamp, the others are done too
+    // once it is
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == 0) {
+        return std::nullopt;
+    }
+
+    std::array<GLuint64, QUERIES> times{};
+    usize const                   count = 2 * (usize{frame.spans} + 1);
+    for (usize i = 0; i < count; i += 1) {
+        glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &times[i]);
+    }
+    this->collected += 1;
+
+    // a phase timed in several spans gets their sum
+    std::array<u64, PHASE_COUNT>  sums{};
+    std::array<bool, PHASE_COUNT> timed{};
+    for (usize span = 0; span < frame.spans; span += 1) {
+        auto const phase = static_cast<usize>(frame.phases[span]);
+        sums[phase] += times[3 + (2 * span)] - times[2 + (2 * span)];
+        timed[phase] = true;
+    }
+    for (usize i = 0; i < PHASE_COUNT; i += 1) {
+        if (timed[i]) {
+            stats.record(
+                static_cast<Phase>(i), std::chrono::nanoseconds(sums[i])
+            );
+        }
+    }
+
+    u64 const elapsed = times[1] - times[0];
+    stats.record(Phase::Gpu, std::chrono::nanoseconds(elapsed));
+    return static_cast<f64>(elapsed) * 1e-9;
+}
+
+auto GpuTimers::begin_frame(Stats &stats) -> std::optional<f64> {
+    if (this->frames[0].queries[0] == 0) {
+        for (Frame &frame : this->frames) {
+            glGenQueries(QUERIES, frame.queries.data());
+        }
+    }
+
+    std::optional<f64> newest{};
+    while (this->collected < this->issued) {
+        std::optional<f64> const seconds = this->collect(stats);
+        if (!seconds.has_value()) {
+            break;
+        }
+        newest = seconds;
+    }
+    // the frame about to be reused was issued GPU_QUERY_DEPTH frames ago
+    if (this->issued - this->collected == GPU_QUERY_DEPTH) {
+        this->collected += 1;
+        this->dropped += 1;
+    }
+
+    Frame &frame = this->frames[this->issued % GPU_QUERY_DEPTH];
+    frame.spans  = 0;
+    glQueryCounter(frame.queries[0], GL_TIMESTAMP);
+    this->open = true;
+    return newest;
+}
+
+void GpuTimers::end_frame() {
+    glQueryCounter(
+        this->frames[this->issued % GPU_QUERY_DEPTH].queries[1], GL_TIMESTAMP
+    );
+    this->issued += 1;
+    this->open = false;
+}
+
+auto GpuTimers::begin(Phase phase) -> std::optional<u8> {
+    Frame &frame = this->frames[this->issued % GPU_QUERY_DEPTH];
+    if (!this->open || frame.spans == GPU_SPANS) {
+        return std::nullopt;
+    }
+    u8 const span      = frame.spans;
+    frame.phases[span] = phase;
+    frame.spans += 1;
+    glQueryCounter(frame.queries[2 + (2 * usize{span})], GL_TIMESTAMP);
+    return span;
+}
+
+void GpuTimers::end(u8 span) {
+    Frame &frame = this->frames[this->issued % GPU_QUERY_DEPTH];
+    glQueryCounter(frame.queries[3 + (2 * usize{span})], GL_TIMESTAMP);
+}
+
+void GpuTimers::destroy() {
+    if (this->frames[0].queries[0] == 0) {
+        return;
+    }
+    for (Frame &frame : this->frames) {
+        glDeleteQueries(QUERIES, frame.queries.data());
+        frame.queries = {};
+    }
+}
+
+GpuZone::GpuZone(Stats &stats, Phase phase)
+    : timers(stats.get_gpu_timers()) {
+    if (this->timers != nullptr) {
+        this->span = this->timers->begin(phase);
+    }
+}
+
+GpuZone::~GpuZone() {
+    if (this->span.has_value()) {
+        this->timers->end(this->span.value());
+    }
+}
+
+} // namespace cell
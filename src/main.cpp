@@ -1,10 +1,204 @@
+#include <algorithm>
+#include <charconv>
+#include <span>
+#include <string_view>
+
 #include <cell/app.hpp>
+#include <cell/arena.hpp>
 #include <util/util.hpp>
 
-auto main() -> int {
+namespace {
+
+template <typename T> auto parse_number(std::string_view text) -> T {
+    T value{};
+    auto const [end, error] =
+        std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size()) {
+        panic("Invalid number {}", text);
+    }
+    return value;
+}
+
+// engine named by an option
+auto parse_engine(std::string_view value) -> cell::LifeEngine {
+    auto const name = std::ranges::find(cell::ENGINE_NAMES, value);
+    if (name == cell::ENGINE_NAMES.end()) {
+        panic("Unknown engine {}", value);
+    }
+    return static_cast<cell::LifeEngine>(name - cell::ENGINE_NAMES.begin());
+}
+
+// cellular --headless [--output DIR] [--generations N] [--every N]
+//                     [--width N] [--height N] [--dimension N] [--rule 1-4]
+//                     [--stats FILE.jsonl|FILE.csv] [--trace FILE.json]
+//                     [--counters] [--metrics PORT|SOCKET] [--huge-pages]
+//                     [--engine bytes|nibbles|planes|counts|frontier]
+auto parse_headless(std::span<char *const> args) -> cell::HeadlessOptions {
+    cell::HeadlessOptions options{};
+    for (cell::usize i = 0; i < args.size(); i += 1) {
+        std::string_view const arg = args[i];
+        if (arg == "--counters") {
+            options.counters = true;
+            continue;
+        }
+        if (arg == "--huge-pages") {
+            options.huge_pages = true;
+            continue;
+        }
+        if (i + 1 == args.size()) {
+            panic("Missing value of {}", arg);
+        }
+        std::string_view const value = args[i += 1];
+
+        if (arg == "--output") {
+            options.output = value;
+        } else if (arg == "--generations") {
+            options.generations = parse_number<cell::u32>(value);
+        } else if (arg == "--every") {
+            options.every = parse_number<cell::u32>(value);
+        } else if (arg == "--width") {
+            options.width = parse_number<cell::u32>(value);
+        } else if (arg == "--height") {
+            options.height = parse_number<cell::u32>(value);
+        } else if (arg == "--dimension") {
+            options.dimension = parse_number<cell::u8>(value);
+        } else if (arg == "--rule") {
+            options.rule = parse_number<cell::u8>(value);
+        } else if (arg == "--stats") {
+            options.stats = value;
+        } else if (arg == "--trace") {
+            options.trace = value;
+        } else if (arg == "--metrics") {
+            options.metrics = value;
+        } else if (arg == "--engine") {
+            options.engine = parse_engine(value);
+        } else {
+            panic("Unknown option {}", arg);
+        }
+    }
+
+    // Life splits its cells evenly between THREAD_COUNT threads
+    if (options.dimension < 16 || options.dimension % 4 != 0) {
+        panic("Dimension must be a multiple of 4 from 16 to 252");
+    }
+    if (options.rule < 1 || options.rule > 4) {
+        panic("Rule must be from 1 to 4");
+    }
+    if (options.every == 0 || options.width == 0 || options.height == 0) {
+        panic("Image size and interval must not be 0");
+    }
+    return options;
+}
+
+// cellular --record [--output FILE.y4m|DIR] [--frames N] [--rule 1-4]
+auto parse_record(std::span<char *const> args) -> cell::RecordOptions {
+    cell::RecordOptions options{};
+    for (cell::usize i = 0; i < args.size(); i += 1) {
+        std::string_view const arg = args[i];
+        if (i + 1 == args.size()) {
+            panic("Missing value of {}", arg);
+        }
+        std::string_view const value = args[i += 1];
+
+        if (arg == "--output") {
+            options.output = value;
+        } else if (arg == "--frames") {
+            options.frames = parse_number<cell::u32>(value);
+        } else if (arg == "--rule") {
+            options.rule = parse_number<cell::u8>(value);
+        } else {
+            panic("Unknown option {}", arg);
+        }
+    }
+
+    if (options.rule < 1 || options.rule > 4) {
+        panic("Rule must be from 1 to 4");
+    }
+    return options;
+}
+
+// milliseconds of an option, as seconds
+auto parse_milliseconds(std::string_view arg, std::string_view value)
+    -> cell::f64 {
+    auto const milliseconds = parse_number<cell::u32>(value);
+    if (milliseconds == 0) {
+        panic("{} must not be 0", arg);
+    }
+    return static_cast<cell::f64>(milliseconds) / 1000.0;
+}
+
+// cellular [--budget MS] [--target MS] [--stats FILE.jsonl|FILE.csv]
+//          [--trace FILE.json] [--counters] [--metrics PORT|SOCKET]
+//          [--huge-pages] [--engine bytes|nibbles|planes|counts|frontier]
+auto parse_run(std::span<char *const> args) -> cell::RunOptions {
+    cell::RunOptions options{};
+    for (cell::usize i = 0; i < args.size(); i += 1) {
+        std::string_view const arg = args[i];
+        if (arg == "--counters") {
+            options.counters = true;
+            continue;
+        }
+        if (arg == "--huge-pages") {
+            options.huge_pages = true;
+            continue;
+        }
+        if (i + 1 == args.size()) {
+            panic("Missing value of {}", arg);
+        }
+        std::string_view const value = args[i += 1];
+
+        if (arg == "--budget") {
+            options.budget = parse_milliseconds(arg, value);
+        } else if (arg == "--target") {
+            options.frame_target = parse_milliseconds(arg, value);
+        } else if (arg == "--stats") {
+            options.stats = value;
+        } else if (arg == "--trace") {
+            options.trace = value;
+        } else if (arg == "--metrics") {
+            options.metrics = value;
+        } else if (arg == "--engine") {
+            options.engine = parse_engine(value);
+        } else {
+            panic("Unknown option {}", arg);
+        }
+    }
+    return options;
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+    std::span<char *const> const args(argv + 1, argc - 1);
     try {
+        if (!args.empty() && std::string_view(args.front()) == "--headless") {
+            cell::HeadlessOptions const options =
+                parse_headless(args.subspan(1));
+            if (options.huge_pages) {
+                cell::use_reserved_huge_pages();
+            }
+            if (options.engine.has_value()) {
+                cell::prefer_engine(options.engine.value());
+            }
+            cell::run_headless(options);
+            return 0;
+        }
+        if (!args.empty() && std::string_view(args.front()) == "--record") {
+            auto state = cell::AppState(false);
+            state.record(parse_record(args.subspan(1)));
+            return 0;
+        }
+        cell::RunOptions const options = parse_run(args);
+        // before the simulation allocates its grids
+        if (options.huge_pages) {
+            cell::use_reserved_huge_pages();
+        }
+        if (options.engine.has_value()) {
+            cell::prefer_engine(options.engine.value());
+        }
+
         auto state = cell::AppState();
-        state.run();
+        state.run(options);
     } catch (std::exception const &exc) {
         eprintln("exception: {}", exc.what());
         return 1;
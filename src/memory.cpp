@@ -0,0 +1,126 @@
+#include <array>
+#include <atomic>
+#include <format>
+#include <utility>
+
+#include <cell/memory.hpp>
+#include <util/util.hpp>
+
+namespace cell {
+
+namespace {
+// by category, then over all of them
+std::array<std::atomic<usize>, MEMORY_COUNT + 1> current{};
+std::array<std::atomic<usize>, MEMORY_COUNT + 1> peak{};
+
+void add_to(usize i, usize bytes) {
+    usize const now =
+        current[i].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    usize highest = peak[i].load(std::memory_order_relaxed);
+    // a failed exchange reloads highest, which another thread raised
+    while (now > highest) {
+        if (peak[i].compare_exchange_weak(
+                highest, now, std::memory_order_relaxed
+            )) {
+            break;
+        }
+    }
+}
+
+void add(Memory category, usize bytes) {
+    add_to(static_cast<usize>(category), bytes);
+    add_to(MEMORY_COUNT, bytes);
+}
+
+void remove(Memory category, usize bytes) {
+    current[static_cast<usize>(category)].fetch_sub(
+        bytes, std::memory_order_relaxed
+    );
+    current[MEMORY_COUNT].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+auto usage(usize i) -> MemoryUsage {
+    return {
+        .current = current[i].load(std::memory_order_relaxed),
+        .peak    = peak[i].load(std::memory_order_relaxed),
+    };
+}
+} // namespace
+
+MemoryAccount::MemoryAccount(Memory category, usize bytes)
+    : category(category), bytes(bytes) {
+    add(this->category, this->bytes);
+}
+
+MemoryAccount::~MemoryAccount() {
+    remove(this->category, this->bytes);
+}
+
+MemoryAccount::MemoryAccount(MemoryAccount const &other)
+    : category(other.category), bytes(other.bytes) {
+    add(this->category, this->bytes);
+}
+
+MemoryAccount::MemoryAccount(MemoryAccount &&other) noexcept
+    : category(other.category), bytes(std::exchange(other.bytes, 0)) {
+}
+
+auto MemoryAccount::operator=(MemoryAccount const &other) -> MemoryAccount & {
+    if (this != &other) {
+        remove(this->category, this->bytes);
+        this->category = other.category;
+        this->bytes    = other.bytes;
+        add(this->category, this->bytes);
+    }
+    return *this;
+}
+
+auto MemoryAccount::operator=(MemoryAccount &&other) noexcept
+    -> MemoryAccount & {
+    if (this != &other) {
+        remove(this->category, this->bytes);
+        this->category = other.category;
+        this->bytes    = std::exchange(other.bytes, 0);
+    }
+    return *this;
+}
+
+void MemoryAccount::set(usize bytes) {
+    remove(this->category, this->bytes);
+    this->bytes = bytes;
+    add(this->category, this->bytes);
+}
+
+auto get_memory(Memory category) -> MemoryUsage {
+    return usage(static_cast<usize>(category));
+}
+
+auto get_total_memory() -> MemoryUsage {
+    return usage(MEMORY_COUNT);
+}
+
+auto format_bytes(usize bytes) -> std::string {
+    return std::format(
+        "{:.1f} MiB", static_cast<f64>(bytes) / (1024.0 * 1024.0)
+    );
+}
+
+void print_memory() {
+    for (usize i = 0; i < MEMORY_COUNT; i += 1) {
+        MemoryUsage const usage = get_memory(static_cast<Memory>(i));
+        eprintln(
+            "memory: {} {}, peak {}",
+            MEMORY_NAMES[i],
+            format_bytes(usage.current),
+            format_bytes(usage.peak)
+        );
+    }
+    MemoryUsage const total = get_total_memory();
+    eprintln(
+        "memory: total {}, peak {}",
+        format_bytes(total.current),
+        format_bytes(total.peak)
+    );
+}
+
+} // namespace cell
@@ -0,0 +1,233 @@
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include <cell/alias.hpp>
+#include <cell/cell.hpp>
+#include <cell/mesh.hpp>
+#include <glm/common.hpp>
+
+namespace cell {
+
+auto ChunkMesh::is_dirty(Life const &life, u8 cx, u8 cy, u8 cz) const
+    -> bool {
+    u64 const stamp = this->chunks[this->idx(cx, cy, cz)].stamp;
+
+    // faces on the border of a chunk depend on the cells across it
+    u64 newest = life.get_chunk_stamp(cx, cy, cz);
+    if (cx > 0) {
+        newest = std::max(newest, life.get_chunk_stamp(cx - 1, cy, cz));
+    }
+    if (cx + 1 < this->chunk_count) {
+        newest = std::max(newest, life.get_chunk_stamp(cx + 1, cy, cz));
+    }
+    if (cy > 0) {
+        newest = std::max(newest, life.get_chunk_stamp(cx, cy - 1, cz));
+    }
+    if (cy + 1 < this->chunk_count) {
+        newest = std::max(newest, life.get_chunk_stamp(cx, cy + 1, cz));
+    }
+    if (cz > 0) {
+        newest = std::max(newest, life.get_chunk_stamp(cx, cy, cz - 1));
+    }
+    if (cz + 1 < this->chunk_count) {
+        newest = std::max(newest, life.get_chunk_stamp(cx, cy, cz + 1));
+    }
+    return newest > stamp;
+}
+
+auto ChunkMesh::is_solid(Life const &life, u32 chunk) const -> bool {
+    auto const cells     = life.get_cells();
+    u32 const  dimension = this->dimension;
+
+    u32 const cx = chunk % this->chunk_count;
+    u32 const cy = (chunk / this->chunk_count) % this->chunk_count;
+    u32 const cz = (chunk / this->chunk_count) / this->chunk_count;
+
+    u32 const x0 = cx * CHUNK_SIZE;
+    u32 const x1 = std::min(x0 + CHUNK_SIZE, dimension);
+    u32 const y1 = std::min((cy + 1) * CHUNK_SIZE, dimension);
+    u32 const z1 = std::min((cz + 1) * CHUNK_SIZE, dimension);
+
+    for (u32 z = cz * CHUNK_SIZE; z < z1; z += 1) {
+        for (u32 y = cy * CHUNK_SIZE; y < y1; y += 1) {
+            auto const row = cells.subspan(
+                (((z * dimension) + y) * dimension) + x0, x1 - x0
+            );
+            if (std::ranges::find(row, 0) != row.end()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void ChunkMesh::build(Life const &life, u32 chunk, u8 level) {
+    auto const cells = life.get_level(level);
+    u32 const  width = life.get_level_dimension(level);
+    u32 const  row   = width;
+    u32 const  slice = width * width;
+    u32 const  size  = CHUNK_SIZE >> level;
+
+    u32 const cx = chunk % this->chunk_count;
+    u32 const cy = (chunk / this->chunk_count) % this->chunk_count;
+    u32 const cz = (chunk / this->chunk_count) / this->chunk_count;
+
+    u32 const x0 = cx * size;
+    u32 const y0 = cy * size;
+    u32 const z0 = cz * size;
+    u32 const x1 = std::min(x0 + size, width);
+    u32 const y1 = std::min(y0 + size, width);
+    u32 const z1 = std::min(z0 + size, width);
+
+    auto &faces = this->chunks[chunk].faces;
+    faces.clear();
+
+    glm::vec3 lower(static_cast<f32>(width));
+    glm::vec3 upper(0.0F);
+
+    for (u32 z = z0; z < z1; z += 1) {
+        for (u32 y = y0; y < y1; y += 1) {
+            for (u32 x = x0; x < x1; x += 1) {
+                u32 const       i     = (z * slice) + (y * row) + x;
+                CellState const state = cells[i];
+                if (state == 0) {
+                    continue;
+                }
+
+                usize const before = faces.size();
+                auto const  emit   = [&](Side side) {
+                    faces.push_back(pack_face(
+                        static_cast<u8>(x),
+                        static_cast<u8>(y),
+                        static_cast<u8>(z),
+                        side,
+                        state
+                    ));
+                };
+
+                // the outside of the world counts as dead
+                if (x == 0 || cells[i - 1] == 0) {
+                    emit(Side::NegX);
+                }
+                if (x + 1 == width || cells[i + 1] == 0) {
+                    emit(Side::PosX);
+                }
+                if (y == 0 || cells[i - row] == 0) {
+                    emit(Side::NegY);
+                }
+                if (y + 1 == width || cells[i + row] == 0) {
+                    emit(Side::PosY);
+                }
+                if (z == 0 || cells[i - slice] == 0) {
+                    emit(Side::NegZ);
+                }
+                if (z + 1 == width || cells[i + slice] == 0) {
+                    emit(Side::PosZ);
+                }
+
+                if (faces.size() != before) {
+                    glm::vec3 const position(x, y, z);
+                    lower = glm::min(lower, position);
+                    upper = glm::max(upper, position);
+                }
+            }
+        }
+    }
+
+    // a cell of the level spans scale cells, centered on its position
+    auto const scale = static_cast<f32>(1U << level);
+    this->chunks[chunk].lower = (lower * scale) - 0.5F;
+    this->chunks[chunk].upper = glm::min(
+        (upper * scale) + scale - 0.5F,
+        static_cast<f32>(this->dimension) - 0.5F
+    );
+    this->chunks[chunk].stamp = life.get_generation();
+    this->chunks[chunk].level = level;
+    this->chunks[chunk].solid = this->is_solid(life, chunk);
+}
+
+auto ChunkMesh::is_occluded(u32 chunk, glm::vec3 const &eye) const -> bool {
+    std::array<u32, 3> const position = {
+        chunk % this->chunk_count,
+        (chunk / this->chunk_count) % this->chunk_count,
+        (chunk / this->chunk_count) / this->chunk_count,
+    };
+
+    bool facing = false;
+    for (usize axis = 0; axis < 3; axis += 1) {
+        u32 const lower = position[axis] * CHUNK_SIZE;
+        u32 const upper = std::min<u32>(lower + CHUNK_SIZE, this->dimension);
+
+        std::array<u32, 3> neighbour = position;
+        if (eye[axis] < static_cast<f32>(lower) - 0.5F) {
+            if (position[axis] == 0) {
+                return false;
+            }
+            neighbour[axis] -= 1;
+        } else if (eye[axis] > static_cast<f32>(upper) - 0.5F) {
+            if (position[axis] + 1 == this->chunk_count) {
+                return false;
+            }
+            neighbour[axis] += 1;
+        } else {
+            continue;
+        }
+
+        u32 const idx = this->idx(neighbour[0], neighbour[1], neighbour[2]);
+        if (!this->chunks[idx].solid) {
+            return false;
+        }
+        facing = true;
+    }
+    return facing;
+}
+
+auto ChunkMesh::update(Life const &life, std::span<u8 const> levels)
+    -> std::vector<u32> {
+    if (life.get_dimension() != this->dimension) {
+        this->dimension   = life.get_dimension();
+        this->chunk_count = life.get_chunk_count();
+        this->chunks.clear();
+        this->chunks.resize(
+            static_cast<usize>(this->chunk_count) * this->chunk_count *
+            this->chunk_count
+        );
+    }
+
+    std::vector<u32> dirty{};
+    for (u8 cz = 0; cz < this->chunk_count; cz += 1) {
+        for (u8 cy = 0; cy < this->chunk_count; cy += 1) {
+            for (u8 cx = 0; cx < this->chunk_count; cx += 1) {
+                u32 const chunk = this->idx(cx, cy, cz);
+                if (this->is_dirty(life, cx, cy, cz) ||
+                    this->chunks[chunk].level != levels[chunk]) {
+                    dirty.push_back(chunk);
+                }
+            }
+        }
+    }
+
+    usize const thread_count = std::min<usize>(THREAD_COUNT, dirty.size());
+    std::atomic<usize>        next = 0;
+    std::vector<std::jthread> threads;
+    threads.reserve(thread_count);
+    for (usize t = 0; t < thread_count; t += 1) {
+        threads.emplace_back([this, &life, levels, &dirty, &next]() {
+            for (usize i = next++; i < dirty.size(); i = next++) {
+                this->build(life, dirty[i], levels[dirty[i]]);
+            }
+        });
+    }
+    threads.clear();
+
+    usize bytes = this->chunks.capacity() * sizeof(ChunkFaces);
+    for (ChunkFaces const &chunk : this->chunks) {
+        bytes += chunk.faces.capacity() * sizeof(u32);
+    }
+    this->memory.set(bytes);
+
+    return dirty;
+}
+
+} // namespace cell
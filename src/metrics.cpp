@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cell/memory.hpp>
+#include <cell/metrics.hpp>
+#include <util/util.hpp>
+
+namespace cell {
+
+namespace {
+// port of address, if it is one
+auto parse_port(std::string_view address) -> std::optional<u16> {
+    u16 port = 0;
+    auto const [end, error] =
+        std::from_chars(address.data(), address.data() + address.size(), port);
+    if (error != std::errc{} || end != address.data() + address.size()) {
+        return std::nullopt;
+    }
+    return port;
+}
+
+// CPU seconds of every thread of the process so far
+auto cpu_time() -> f64 {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto const seconds = [](timeval const &time) {
+        return static_cast<f64>(time.tv_sec) +
+               (static_cast<f64>(time.tv_usec) / 1e6);
+    };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+// bytes of the process resident in memory
+auto resident_bytes() -> u64 {
+    std::ifstream statm("/proc/self/statm");
+    u64           size     = 0;
+    u64           resident = 0;
+    statm >> size >> resident;
+    return resident * static_cast<u64>(sysconf(_SC_PAGESIZE));
+}
+
+void describe(
+    std::string     &out,
+    std::string_view name,
+    std::string_view type,
+    std::string_view help
+) {
+    out += std::format("# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+}
+} // namespace
+
+MetricsServer::MetricsServer(std::string_view address)
+    : snapshots(std::string()), address(address) {
+    std::optional<u16> const port = parse_port(address);
+    if (port.has_value()) {
+        this->socket = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        i32 const reuse = 1;
+        setsockopt(
+            this->socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)
+        );
+
+        sockaddr_in local{};
+        local.sin_family      = AF_INET;
+        local.sin_port        = htons(port.value());
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(
+                this->socket,
+                reinterpret_cast<sockaddr const *>(&local),
+                sizeof(local)
+            ) != 0) {
+            panic("Could not listen on port {}", address);
+        }
+    } else {
+        sockaddr_un local{};
+        if (address.size() >= sizeof(local.sun_path)) {
+            panic("Socket path too long {}", address);
+        }
+        this->socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        local.sun_family = AF_UNIX;
+        std::ranges::copy(address, local.sun_path);
+        // left behind by a run that was killed
+        unlink(this->address.c_str());
+        if (bind(
+                this->socket,
+                reinterpret_cast<sockaddr const *>(&local),
+                sizeof(local)
+            ) != 0) {
+            panic("Could not listen on socket {}", address);
+        }
+    }
+    if (listen(this->socket, SOMAXCONN) != 0) {
+        panic("Could not listen on {}", address);
+    }
+
+    this->last_cpu_time = cpu_time();
+    this->thread = std::jthread([this](std::stop_token const &stop) {
+        this->serve(stop);
+    });
+    eprintln("metrics: serving on {}", address);
+}
+
+MetricsServer::~MetricsServer() {
+    // before the socket goes away under it
+    this->thread.request_stop();
+    this->thread.join();
+    close(this->socket);
+    if (!parse_port(this->address).has_value()) {
+        unlink(this->address.c_str());
+    }
+}
+
+void MetricsServer::serve(std::stop_token const &stop) {
+    while (!stop.stop_requested()) {
+        pollfd listener{.fd = this->socket, .events = POLLIN, .revents = 0};
+        if (poll(&listener, 1, METRICS_POLL_TIMEOUT) <= 0) {
+            continue;
+        }
+        i32 const client = accept(this->socket, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+
+        // a client that stalls only holds up the next scrapes
+        timeval const timeout{.tv_sec = 1, .tv_usec = 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        // every request gets the metrics, whatever it asks for
+        std::array<char, 1024> request{};
+        if (recv(client, request.data(), request.size(), 0) > 0) {
+            std::string const &body     = this->snapshots.read();
+            std::string const  response = std::format(
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Type: text/plain; version=0.0.4\r\n"
+                "Content-Length: {}\r\n"
+                "Connection: close\r\n\r\n{}",
+                body.size(),
+                body
+            );
+            usize sent = 0;
+            while (sent < response.size()) {
+                isize const n = send(
+                    client,
+                    response.data() + sent,
+                    response.size() - sent,
+                    MSG_NOSIGNAL
+                );
+                if (n <= 0) {
+                    break;
+                }
+                sent += static_cast<usize>(n);
+            }
+        }
+        close(client);
+    }
+}
+
+void MetricsServer::publish(Stats const &stats, Life const &life, f64 time) {
+    f64 const interval    = time - this->last_time;
+    u64 const generation  = life.get_generation();
+    f64 const cpu_seconds = cpu_time();
+    // a restart sets the generation back
+    f64 const rate =
+        interval <= 0.0 || generation < this->last_generation
+            ? 0.0
+            : static_cast<f64>(generation - this->last_generation) / interval;
+
+    std::string out{};
+
+    describe(
+        out,
+        "cellular_generation",
+        "gauge",
+        "Generations since the world was last restarted."
+    );
+    out += std::format("cellular_generation {}\n", generation);
+    describe(
+        out,
+        "cellular_generations_per_second",
+        "gauge",
+        "Generations per second over the last interval."
+    );
+    out += std::format("cellular_generations_per_second {}\n", rate);
+    describe(
+        out,
+        "cellular_cell_updates_per_second",
+        "gauge",
+        "Cells updated per second over the last interval."
+    );
+    out += std::format(
+        "cellular_cell_updates_per_second {}\n",
+        rate * static_cast<f64>(life.size())
+    );
+
+    std::array<u64, 256> population{};
+    for (CellState const state : life.get_cells()) {
+        population[state] += 1;
+    }
+    describe(
+        out,
+        "cellular_population",
+        "gauge",
+        "Cells in each state, 0 being dead."
+    );
+    for (usize state = 0; state < population.size(); state += 1) {
+        if (population[state] != 0) {
+            out += std::format(
+                "cellular_population{{state=\"{}\"}} {}\n",
+                state,
+                population[state]
+            );
+        }
+    }
+
+    describe(
+        out,
+        "cellular_phase_seconds",
+        "summary",
+        "Latency of each phase, quantiles over the last interval."
+    );
+    for (usize i = 0; i < PHASE_COUNT; i += 1) {
+        auto const       phase  = static_cast<Phase>(i);
+        Histogram const &recent = stats.get_recent(phase);
+        // the totals do not have the last interval yet
+        Histogram total = stats.get_total(phase);
+        total.merge(recent);
+        for (f64 const quantile : {0.5, 0.99, 0.999}) {
+            out += std::format(
+                "cellular_phase_seconds{{phase=\"{}\",quantile=\"{}\"}} {}\n",
+                PHASE_NAMES[i],
+                quantile,
+                static_cast<f64>(recent.percentile(quantile)) / 1e9
+            );
+        }
+        out += std::format(
+            "cellular_phase_seconds_sum{{phase=\"{}\"}} {}\n"
+            "cellular_phase_seconds_count{{phase=\"{}\"}} {}\n",
+            PHASE_NAMES[i],
+            total.get_mean() * static_cast<f64>(total.get_count()) / 1e9,
+            PHASE_NAMES[i],
+            total.get_count()
+        );
+    }
+
+    describe(
+        out,
+        "cellular_phase_busy_ratio",
+        "gauge",
+        "Fraction of the last interval spent in each phase."
+    );
+    for (usize i = 0; i < PHASE_COUNT; i += 1) {
+        Histogram const &recent = stats.get_recent(static_cast<Phase>(i));
+        f64 const        busy =
+            recent.get_mean() * static_cast<f64>(recent.get_count()) / 1e9;
+        out += std::format(
+            "cellular_phase_busy_ratio{{phase=\"{}\"}} {}\n",
+            PHASE_NAMES[i],
+            interval <= 0.0 ? 0.0 : busy / interval
+        );
+    }
+
+    describe(
+        out,
+        "cellular_cpu_seconds_total",
+        "counter",
+        "CPU seconds of every thread of the process."
+    );
+    out += std::format("cellular_cpu_seconds_total {}\n", cpu_seconds);
+    describe(
+        out,
+        "cellular_cpu_utilisation",
+        "gauge",
+        "Fraction of the hardware threads busy over the last interval."
+    );
+    auto const threads =
+        static_cast<f64>(std::max(std::thread::hardware_concurrency(), 1U));
+    out += std::format(
+        "cellular_cpu_utilisation {}\n",
+        interval <= 0.0
+            ? 0.0
+            : (cpu_seconds - this->last_cpu_time) / interval / threads
+    );
+    describe(
+        out,
+        "cellular_memory_bytes",
+        "gauge",
+        "Bytes accounted to each category of allocation."
+    );
+    for (usize i = 0; i < MEMORY_COUNT; i += 1) {
+        out += std::format(
+            "cellular_memory_bytes{{category=\"{}\"}} {}\n",
+            MEMORY_NAMES[i],
+            get_memory(static_cast<Memory>(i)).current
+        );
+    }
+    describe(
+        out,
+        "cellular_memory_peak_bytes",
+        "gauge",
+        "Most bytes accounted to each category of allocation so far."
+    );
+    for (usize i = 0; i < MEMORY_COUNT; i += 1) {
+        out += std::format(
+            "cellular_memory_peak_bytes{{category=\"{}\"}} {}\n",
+            MEMORY_NAMES[i],
+            get_memory(static_cast<Memory>(i)).peak
+        );
+    }
+    describe(
+        out,
+        "cellular_resident_bytes",
+        "gauge",
+        "Bytes of the process resident in memory."
+    );
+    out += std::format("cellular_resident_bytes {}\n", resident_bytes());
+
+    this->snapshots.get_back() = std::move(out);
+    this->snapshots.publish();
+
+    this->last_time       = time;
+    this->last_generation = generation;
+    this->last_cpu_time   = cpu_seconds;
+}
+
+} // namespace cell
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+#include <cell/raycast.hpp>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <glm/vector_relational.hpp>
+#include <util/util.hpp>
+
+namespace cell {
+
+namespace {
+// side of the square tiles the image is split into
+constexpr u32 TILE_SIZE = 32;
+
+// colour of a cell, see cell_color in shader/color.glsl
+auto cell_color(
+    CellColor const &color,
+    Life const      &life,
+    CellState        state,
+    glm::vec3 const &position
+) -> glm::vec3 {
+    f32 const       half        = static_cast<f32>(life.get_dimension() >> 1U);
+    glm::vec3 const from_center = position - half;
+    f32 const       distance =
+        glm::dot(from_center, from_center) / life.get_max_distance();
+    switch (color.gradient) {
+        case ColorGradient::Distance:
+            return glm::mix(color.from, color.to, distance);
+        case ColorGradient::DistanceSqrt:
+            return glm::mix(color.from, color.to, std::sqrt(distance));
+        case ColorGradient::Position:
+            return position / static_cast<f32>(life.get_dimension());
+        case ColorGradient::State:
+            break;
+    }
+    return color.palette[std::min<usize>(state, MAX_PALETTE_SIZE - 1)];
+}
+
+// state of the block of a level of the Life pyramid holding cell
+auto block_state(Life const &life, u8 level, glm::ivec3 const &cell)
+    -> CellState {
+    auto const       cells = life.get_level(level);
+    i32 const        side  = life.get_level_dimension(level);
+    glm::ivec3 const block = cell >> static_cast<i32>(level);
+    return cells[(((block.z * side) + block.y) * side) + block.x];
+}
+
+struct Hit {
+    glm::ivec3 cell;
+    // 0 if the ray left the world without hitting a live cell
+    CellState  state;
+};
+
+// First live cell along the ray. Cell c covers [c, c + 1) on each axis.
+auto march(Life const &life, glm::vec3 const &origin, glm::vec3 direction)
+    -> Hit {
+    // axis aligned rays would divide by zero
+    for (i32 axis = 0; axis < 3; axis += 1) {
+        if (std::abs(direction[axis]) < 1e-6F) {
+            direction[axis] = 1e-6F;
+        }
+    }
+    glm::vec3 const inverse = 1.0F / direction;
+
+    i32 const       dimension = life.get_dimension();
+    glm::vec3 const lower     = -origin * inverse;
+    glm::vec3 const upper =
+        (glm::vec3(static_cast<f32>(dimension)) - origin) * inverse;
+    glm::vec3 const enters = glm::min(lower, upper);
+    glm::vec3 const leaves = glm::max(lower, upper);
+    f32 const enter = std::max({enters.x, enters.y, enters.z, 0.0F});
+    f32 const leave = std::min({leaves.x, leaves.y, leaves.z});
+    if (enter >= leave) {
+        return {.cell = {}, .state = 0};
+    }
+
+    // descend the pyramid into occupied blocks and step over empty ones,
+    // moving the cell itself across the face the ray leaves through so
+    // rounding can never keep it in the same block
+    glm::ivec3 cell = glm::clamp(
+        glm::ivec3(glm::floor(origin + (direction * enter))), 0, dimension - 1
+    );
+    u8 level = LOD_LEVELS;
+    while (true) {
+        CellState const state = block_state(life, level, cell);
+        if (state != 0) {
+            if (level == 0) {
+                return {.cell = cell, .state = state};
+            }
+            level -= 1;
+            continue;
+        }
+
+        i32 const        shift       = level;
+        glm::ivec3 const block_lower = (cell >> shift) << shift;
+        glm::ivec3 const block_upper = block_lower + (1 << shift);
+
+        glm::vec3 exits{};
+        for (i32 axis = 0; axis < 3; axis += 1) {
+            f32 const face = static_cast<f32>(
+                direction[axis] > 0.0F ? block_upper[axis] : block_lower[axis]
+            );
+            exits[axis] = (face - origin[axis]) * inverse[axis];
+        }
+        i32 const axis =
+            exits.x < exits.y ? (exits.x < exits.z ? 0 : 2)
+                              : (exits.y < exits.z ? 1 : 2);
+
+        glm::ivec3 next = glm::clamp(
+            glm::ivec3(glm::floor(origin + (direction * exits[axis]))),
+            block_lower,
+            block_upper - 1
+        );
+        next[axis] = direction[axis] > 0.0F ? block_upper[axis]
+                                            : block_lower[axis] - 1;
+        if (glm::any(glm::lessThan(next, glm::ivec3(0))) ||
+            glm::any(glm::greaterThanEqual(next, glm::ivec3(dimension)))) {
+            return {.cell = {}, .state = 0};
+        }
+
+        cell  = next;
+        level = std::min<u8>(level + 1, LOD_LEVELS);
+    }
+}
+} // namespace
+
+void write_ppm(Image const &image, std::filesystem::path const &path) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        panic("Could not write image file {}", path.string());
+    }
+    file << "P6\n" << image.width << ' ' << image.height << "\n255\n";
+    file.write(
+        reinterpret_cast<char const *>(image.pixels.data()),
+        static_cast<std::streamsize>(image.pixels.size())
+    );
+}
+
+Raycaster::Raycaster(u32 width, u32 height)
+    : image{
+          .width  = width,
+          .height = height,
+          .pixels = std::vector<u8>(static_cast<usize>(width) * height * 3),
+      },
+      memory(Memory::RenderCache, this->image.pixels.size()) {
+}
+
+void Raycaster::draw_tile(
+    Life const      &life,
+    CellColor const &color,
+    glm::mat4 const &inverse,
+    u32              tile
+) {
+    u32 const width   = this->image.width;
+    u32 const height  = this->image.height;
+    u32 const columns = (width + TILE_SIZE - 1) / TILE_SIZE;
+    u32 const x0      = (tile % columns) * TILE_SIZE;
+    u32 const y0      = (tile / columns) * TILE_SIZE;
+    u32 const x1      = std::min(x0 + TILE_SIZE, width);
+    u32 const y1      = std::min(y0 + TILE_SIZE, height);
+
+    for (u32 y = y0; y < y1; y += 1) {
+        for (u32 x = x0; x < x1; x += 1) {
+            glm::vec2 const ndc(
+                ((static_cast<f32>(x) + 0.5F) / static_cast<f32>(width) * 2.0F
+                ) - 1.0F,
+                1.0F - ((static_cast<f32>(y) + 0.5F) /
+                        static_cast<f32>(height) * 2.0F)
+            );
+            glm::vec4 const near = inverse * glm::vec4(ndc, -1.0F, 1.0F);
+            glm::vec4 const far  = inverse * glm::vec4(ndc, 1.0F, 1.0F);
+
+            // shifted so cell c covers [c, c + 1), see march
+            glm::vec3 const origin = (glm::vec3(near) / near.w) + 0.5F;
+            glm::vec3 const direction = glm::normalize(
+                (glm::vec3(far) / far.w) - (glm::vec3(near) / near.w)
+            );
+
+            Hit const hit = march(life, origin, direction);
+            glm::vec3 rgb(0.0F);
+            if (hit.state != 0) {
+                rgb = glm::clamp(
+                    cell_color(color, life, hit.state, glm::vec3(hit.cell)),
+                    0.0F,
+                    1.0F
+                );
+            }
+
+            u8 *pixel = &this->image.pixels[((y * width) + x) * 3];
+            for (i32 channel = 0; channel < 3; channel += 1) {
+                pixel[channel] =
+                    static_cast<u8>(std::lround(rgb[channel] * 255.0F));
+            }
+        }
+    }
+}
+
+auto Raycaster::draw(
+    Life const &life, CellColor const &color, Camera const &camera
+) -> Image const & {
+    glm::mat4 const inverse = glm::inverse(camera.mvp);
+
+    u32 const columns = (this->image.width + TILE_SIZE - 1) / TILE_SIZE;
+    u32 const rows    = (this->image.height + TILE_SIZE - 1) / TILE_SIZE;
+    u32 const tiles   = columns * rows;
+
+    std::atomic<u32> next = 0;
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(THREAD_COUNT);
+        for (u8 t = 0; t < THREAD_COUNT; t += 1) {
+            threads.emplace_back([&]() {
+                for (u32 tile = next++; tile < tiles; tile = next++) {
+                    this->draw_tile(life, color, inverse, tile);
+                }
+            });
+        }
+    }
+
+    return this->image;
+}
+
+} // namespace cell
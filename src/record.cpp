@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <format>
+
+#include <cell/record.hpp>
+#include <util/util.hpp>
+
+namespace cell {
+
+namespace {
+auto to_byte(f32 value) -> u8 {
+    return static_cast<u8>(std::clamp(std::lround(value), 0L, 255L));
+}
+
+// Full range BT.601 YUV 4:2:0, the C420jpeg of the y4m header: a plane of
+// luma, then the two chroma planes at half the resolution on each axis.
+auto to_yuv420(Image const &image) -> std::vector<u8> {
+    u32 const   width  = image.width;
+    u32 const   height = image.height;
+    usize const luma   = static_cast<usize>(width) * height;
+
+    std::vector<u8> yuv(luma + (luma / 2));
+    u8 *const       u_plane = yuv.data() + luma;
+    u8 *const       v_plane = u_plane + (luma / 4);
+
+    auto const rgb = [&](u32 x, u32 y) -> glm::vec3 {
+        u8 const *pixel = &image.pixels[((y * width) + x) * 3];
+        return {pixel[0], pixel[1], pixel[2]};
+    };
+
+    for (u32 y = 0; y < height; y += 1) {
+        for (u32 x = 0; x < width; x += 1) {
+            glm::vec3 const c = rgb(x, y);
+            yuv[(y * width) + x] =
+                to_byte((0.299F * c.r) + (0.587F * c.g) + (0.114F * c.b));
+        }
+    }
+
+    for (u32 y = 0; y < height; y += 2) {
+        for (u32 x = 0; x < width; x += 2) {
+            glm::vec3 const c = (rgb(x, y) + rgb(x + 1, y) + rgb(x, y + 1) +
+                                 rgb(x + 1, y + 1)) *
+                                0.25F;
+            usize const i = ((y / 2) * (width / 2)) + (x / 2);
+            u_plane[i]    = to_byte(
+                (-0.168736F * c.r) - (0.331264F * c.g) + (0.5F * c.b) + 128.0F
+            );
+            v_plane[i] = to_byte(
+                (0.5F * c.r) - (0.418688F * c.g) - (0.081312F * c.b) + 128.0F
+            );
+        }
+    }
+
+    return yuv;
+}
+} // namespace
+
+FrameReader::FrameReader(u32 width, u32 height)
+    : width(width), height(height) {
+    isize const size = static_cast<isize>(width) * height * 3;
+
+    glGenBuffers(READBACK_DEPTH, this->buffers.data());
+    for (GLuint const buffer : this->buffers) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    this->gpu_memory.set(static_cast<usize>(size) * READBACK_DEPTH);
+}
+
+auto FrameReader::collect() -> Image {
+    usize const row = static_cast<usize>(this->width) * 3;
+    Image       image{
+        .width  = this->width,
+        .height = this->height,
+        .pixels = std::vector<u8>(row * this->height),
+    };
+
+    glBindBuffer(
+        GL_PIXEL_PACK_BUFFER, this->buffers[this->collected % READBACK_DEPTH]
+    );
+    auto const *pixels = static_cast<u8 const *>(glMapBufferRange(
+        GL_PIXEL_PACK_BUFFER,
+        0,
+        static_cast<isize>(image.pixels.size()),
+        GL_MAP_READ_BIT
+    ));
+    if (pixels == nullptr) {
+        panic("Failed to map pixel buffer");
+    }
+
+    // glReadPixels starts from the bottom row
+    for (u32 y = 0; y < this->height; y += 1) {
+        std::memcpy(
+            &image.pixels[y * row],
+            pixels + ((this->height - 1 - y) * row),
+            row
+        );
+    }
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    this->collected += 1;
+    return image;
+}
+
+auto FrameReader::read() -> std::optional<Image> {
+    // the buffer about to be reused holds the oldest frame
+    std::optional<Image> image{};
+    if (this->issued - this->collected == READBACK_DEPTH) {
+        image = this->collect();
+    }
+
+    glBindBuffer(
+        GL_PIXEL_PACK_BUFFER, this->buffers[this->issued % READBACK_DEPTH]
+    );
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(
+        0,
+        0,
+        static_cast<i32>(this->width),
+        static_cast<i32>(this->height),
+        GL_RGB,
+        GL_UNSIGNED_BYTE,
+        nullptr
+    );
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    this->issued += 1;
+    return image;
+}
+
+auto FrameReader::flush() -> std::vector<Image> {
+    std::vector<Image> images{};
+    while (this->collected < this->issued) {
+        images.push_back(this->collect());
+    }
+    return images;
+}
+
+void FrameReader::destroy() {
+    glDeleteBuffers(READBACK_DEPTH, this->buffers.data());
+    this->gpu_memory.set(0);
+}
+
+FrameEncoder::FrameEncoder(
+    std::filesystem::path output, u32 width, u32 height
+)
+    : output(std::move(output)), width(width), height(height),
+      y4m(this->output.extension() == ".y4m") {
+    if (this->y4m) {
+        if (width % 2 != 0 || height % 2 != 0) {
+            panic("Y4M frames need an even size, not {}x{}", width, height);
+        }
+        this->stream.open(this->output, std::ios::binary);
+        if (!this->stream.is_open()) {
+            panic("Could not write video file {}", this->output.string());
+        }
+        this->stream << std::format(
+            "YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C420jpeg\n",
+            width,
+            height,
+            RECORD_FRAME_RATE
+        );
+    } else {
+        std::filesystem::create_directories(this->output);
+    }
+
+    this->threads.reserve(THREAD_COUNT);
+    for (u8 t = 0; t < THREAD_COUNT; t += 1) {
+        this->threads.emplace_back([this]() { this->work(); });
+    }
+}
+
+FrameEncoder::~FrameEncoder() {
+    {
+        std::scoped_lock const lock(this->mutex);
+        this->done = true;
+    }
+    this->changed.notify_all();
+    // the workers drain the queue before leaving
+    this->threads.clear();
+}
+
+void FrameEncoder::push(Image image) {
+    std::unique_lock lock(this->mutex);
+    this->changed.wait(lock, [this]() {
+        return this->queue.size() < THREAD_COUNT;
+    });
+    this->queue.emplace_back(this->pushed, std::move(image));
+    this->pushed += 1;
+    lock.unlock();
+    this->changed.notify_all();
+}
+
+void FrameEncoder::work() {
+    while (true) {
+        std::unique_lock lock(this->mutex);
+        this->changed.wait(lock, [this]() {
+            return this->done || !this->queue.empty();
+        });
+        if (this->queue.empty()) {
+            return;
+        }
+        auto [index, image] = std::move(this->queue.front());
+        this->queue.pop_front();
+        lock.unlock();
+        this->changed.notify_all();
+
+        this->encode(index, image);
+    }
+}
+
+void FrameEncoder::encode(u64 index, Image const &image) {
+    if (!this->y4m) {
+        write_ppm(image, this->output / std::format("{:06}.ppm", index));
+        return;
+    }
+
+    std::vector<u8> const yuv = to_yuv420(image);
+
+    std::unique_lock lock(this->mutex);
+    this->changed.wait(lock, [&]() { return this->written == index; });
+    this->stream << "FRAME\n";
+    this->stream.write(
+        reinterpret_cast<char const *>(yuv.data()),
+        static_cast<std::streamsize>(yuv.size())
+    );
+    this->written += 1;
+    lock.unlock();
+    this->changed.notify_all();
+}
+
+} // namespace cell
@@ -0,0 +1,657 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <cell/gpu_timer.hpp>
+#include <cell/render.hpp>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec4.hpp>
+#include <util/util.hpp>
+
+namespace cell {
+
+namespace {
+// vertices in the triangle strip generated by shader/cube.vert
+constexpr i32 CUBE_STRIP_SIZE = 14;
+
+// vertices of the two triangles of a face in shader/chunk.vert
+constexpr i32 FACE_VERTICES = 6;
+
+// projected size, in pixels, below which cells are merged into the next
+// level of the Life pyramid
+constexpr f32 LOD_PIXELS = 1.0F;
+
+// extra faces reserved for a chunk on relayout, so a chunk that grows a
+// little does not move every other chunk
+constexpr auto chunk_capacity(usize faces) -> u32 {
+    return static_cast<u32>(faces + (faces / 2) + 64);
+}
+
+// Planes of the view frustum, pointing inwards, extracted from the rows of
+// the model-view-projection matrix.
+class Frustum {
+    std::array<glm::vec4, 6> planes;
+
+  public:
+    explicit Frustum(glm::mat4 const &mvp) {
+        glm::mat4 const rows = glm::transpose(mvp);
+        this->planes         = {
+            rows[3] + rows[0],
+            rows[3] - rows[0],
+            rows[3] + rows[1],
+            rows[3] - rows[1],
+            rows[3] + rows[2],
+            rows[3] - rows[2],
+        };
+    }
+
+    [[nodiscard]] auto
+    intersects(glm::vec3 const &lower, glm::vec3 const &upper) const -> bool {
+        return std::ranges::all_of(this->planes, [&](glm::vec4 const &plane) {
+            // corner of the box furthest along the plane normal
+            glm::vec3 const corner(
+                plane.x > 0.0F ? upper.x : lower.x,
+                plane.y > 0.0F ? upper.y : lower.y,
+                plane.z > 0.0F ? upper.z : lower.z
+            );
+            return glm::dot(glm::vec3(plane), corner) + plane.w >= 0.0F;
+        });
+    }
+};
+
+auto chunk_center(Life const &life, u32 chunk) -> glm::vec3 {
+    u8 const  count = life.get_chunk_count();
+    glm::vec3 lower(
+        chunk % count, (chunk / count) % count, (chunk / count) / count
+    );
+    lower *= static_cast<f32>(CHUNK_SIZE);
+    glm::vec3 const upper = glm::min(
+        lower + static_cast<f32>(CHUNK_SIZE), glm::vec3(life.get_dimension())
+    );
+    return ((lower + upper) * 0.5F) - 0.5F;
+}
+
+// Copies the box between lower and upper of a level of the Life pyramid to
+// the same mip level of the bound 3D texture.
+void upload_box(
+    Life const &life, u8 level, glm::uvec3 const &lower, glm::uvec3 const &upper
+) {
+    auto const  cells = life.get_level(level);
+    usize const side  = life.get_level_dimension(level);
+    usize const first = (((lower.z * side) + lower.y) * side) + lower.x;
+    glm::ivec3 const offset(lower);
+    glm::ivec3 const size(upper - lower);
+    glTexSubImage3D(
+        GL_TEXTURE_3D,
+        level,
+        offset.x,
+        offset.y,
+        offset.z,
+        size.x,
+        size.y,
+        size.z,
+        GL_RED_INTEGER,
+        GL_UNSIGNED_BYTE,
+        cells.data() + first
+    );
+}
+
+auto uniform_location(Shader const &shader, std::string const &name)
+    -> GLint {
+    std::optional<i32> const loc = shader.get_uniform(name);
+    if (!loc.has_value()) {
+        panic("Failed to get position of uniform {}", name);
+    }
+    return loc.value();
+}
+} // namespace
+
+ColorUniforms::ColorUniforms(Shader const &shader)
+    : gradient(uniform_location(shader, "gradient")),
+      palette(uniform_location(shader, "palette")),
+      from(uniform_location(shader, "gradient_from")),
+      to(uniform_location(shader, "gradient_to")),
+      max_distance(uniform_location(shader, "max_distance")),
+      dimension(uniform_location(shader, "dimension")) {
+}
+
+void ColorUniforms::set(CellColor const &color, Life const &life) const {
+    glUniform1ui(this->gradient, static_cast<u32>(color.gradient));
+    glUniform3fv(
+        this->palette,
+        MAX_PALETTE_SIZE,
+        glm::value_ptr(color.palette.front())
+    );
+    glUniform3fv(this->from, 1, glm::value_ptr(color.from));
+    glUniform3fv(this->to, 1, glm::value_ptr(color.to));
+    glUniform1f(this->max_distance, life.get_max_distance());
+    glUniform1ui(this->dimension, life.get_dimension());
+}
+
+CubeRenderer::CubeRenderer(Shader program)
+    : program(program), mvp_location(uniform_location(program, "MVP")),
+      color_uniforms(program) {
+    std::optional<i32> const vertex_cell = program.get_attribute("cell");
+    if (!vertex_cell.has_value()) {
+        panic("Failed to get position of attribute");
+    }
+    this->vertex_cell = vertex_cell.value();
+
+    glGenVertexArrays(1, &this->VAO);
+    glGenBuffers(1, &this->cell_buffer);
+}
+
+void CubeRenderer::draw(
+    Life const      &life,
+    CellColor const &color,
+    Camera const    &camera,
+    Stats           &stats
+) {
+    std::vector<u32> cells;
+    {
+        PhaseTimer const timer(stats, Phase::Compaction, life.size());
+        cells = life.draw();
+    }
+
+    this->program.use();
+    this->color_uniforms.set(color, life);
+    glUniformMatrix4fv(
+        this->mvp_location, 1, 0U, glm::value_ptr(camera.mvp)
+    );
+
+    glBindVertexArray(this->VAO);
+
+    // one instance of the unit cube per live cell, expanded from gl_VertexID
+    glBindBuffer(GL_ARRAY_BUFFER, this->cell_buffer);
+    {
+        PhaseTimer const timer(stats, Phase::Upload);
+        GpuZone const    gpu(stats, Phase::GpuUpload);
+        glBufferData(
+            GL_ARRAY_BUFFER,
+            static_cast<isize>(cells.size() * sizeof(u32)),
+            cells.data(),
+            GL_STREAM_DRAW
+        );
+        this->gpu_memory.set(cells.size() * sizeof(u32));
+    }
+    glVertexAttribIPointer(this->vertex_cell, 1, GL_UNSIGNED_INT, 0, nullptr);
+    glVertexAttribDivisor(this->vertex_cell, 1);
+    glEnableVertexAttribArray(this->vertex_cell);
+
+    {
+        GpuZone const gpu(stats, Phase::GpuDraw);
+        glDrawArraysInstanced(
+            GL_TRIANGLE_STRIP,
+            0,
+            CUBE_STRIP_SIZE,
+            static_cast<i32>(cells.size())
+        );
+    }
+
+    glDisableVertexAttribArray(this->vertex_cell);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void CubeRenderer::destroy() {
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->cell_buffer);
+    this->gpu_memory.set(0);
+}
+
+PointRenderer::PointRenderer(Shader program)
+    : program(program), mvp_location(uniform_location(program, "MVP")),
+      inverse_location(uniform_location(program, "inverse_MVP")),
+      viewport_location(uniform_location(program, "viewport")),
+      pixel_scale_location(uniform_location(program, "pixel_scale")),
+      color_uniforms(program) {
+    std::optional<i32> const vertex_cell = program.get_attribute("cell");
+    if (!vertex_cell.has_value()) {
+        panic("Failed to get position of attribute");
+    }
+    this->vertex_cell = vertex_cell.value();
+
+    glGenVertexArrays(1, &this->VAO);
+    glGenBuffers(1, &this->cell_buffer);
+}
+
+void PointRenderer::draw(
+    Life const      &life,
+    CellColor const &color,
+    Camera const    &camera,
+    Stats           &stats
+) {
+    std::vector<u32> cells;
+    {
+        PhaseTimer const timer(stats, Phase::Compaction, life.size());
+        cells = life.draw();
+    }
+
+    glm::mat4 const inverse = glm::inverse(camera.mvp);
+
+    this->program.use();
+    this->color_uniforms.set(color, life);
+    glUniformMatrix4fv(
+        this->mvp_location, 1, 0U, glm::value_ptr(camera.mvp)
+    );
+    glUniformMatrix4fv(
+        this->inverse_location, 1, 0U, glm::value_ptr(inverse)
+    );
+    glUniform2fv(this->viewport_location, 1, glm::value_ptr(camera.viewport));
+    glUniform1f(this->pixel_scale_location, camera.pixel_scale);
+
+    glBindVertexArray(this->VAO);
+
+    // one point per live cell, sized by shader/point.vert
+    glBindBuffer(GL_ARRAY_BUFFER, this->cell_buffer);
+    {
+        PhaseTimer const timer(stats, Phase::Upload);
+        GpuZone const    gpu(stats, Phase::GpuUpload);
+        glBufferData(
+            GL_ARRAY_BUFFER,
+            static_cast<isize>(cells.size() * sizeof(u32)),
+            cells.data(),
+            GL_STREAM_DRAW
+        );
+        this->gpu_memory.set(cells.size() * sizeof(u32));
+    }
+    glVertexAttribIPointer(this->vertex_cell, 1, GL_UNSIGNED_INT, 0, nullptr);
+    glEnableVertexAttribArray(this->vertex_cell);
+
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    {
+        GpuZone const gpu(stats, Phase::GpuDraw);
+        glDrawArrays(GL_POINTS, 0, static_cast<i32>(cells.size()));
+    }
+    glDisable(GL_PROGRAM_POINT_SIZE);
+
+    glDisableVertexAttribArray(this->vertex_cell);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void PointRenderer::destroy() {
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->cell_buffer);
+    this->gpu_memory.set(0);
+}
+
+ChunkRenderer::ChunkRenderer(Shader program)
+    : program(program), mvp_location(uniform_location(program, "MVP")),
+      faces_location(uniform_location(program, "faces")),
+      level_location(uniform_location(program, "level")),
+      color_uniforms(program) {
+    glGenVertexArrays(1, &this->VAO);
+    glGenBuffers(1, &this->face_buffer);
+    glGenTextures(1, &this->face_texture);
+}
+
+void ChunkRenderer::relayout() {
+    auto const chunks = this->mesh.get_chunks();
+
+    this->offsets.resize(chunks.size());
+    this->capacities.resize(chunks.size());
+
+    u32 total = 0;
+    for (usize i = 0; i < chunks.size(); i += 1) {
+        this->offsets[i]    = total;
+        this->capacities[i] = chunk_capacity(chunks[i].faces.size());
+        total += this->capacities[i];
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, this->face_buffer);
+    glBufferData(
+        GL_TEXTURE_BUFFER,
+        static_cast<isize>(total * sizeof(u32)),
+        nullptr,
+        GL_DYNAMIC_DRAW
+    );
+    this->gpu_memory.set(total * sizeof(u32));
+    for (usize i = 0; i < chunks.size(); i += 1) {
+        glBufferSubData(
+            GL_TEXTURE_BUFFER,
+            static_cast<isize>(this->offsets[i] * sizeof(u32)),
+            static_cast<isize>(chunks[i].faces.size() * sizeof(u32)),
+            chunks[i].faces.data()
+        );
+    }
+
+    glBindTexture(GL_TEXTURE_BUFFER, this->face_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, this->face_buffer);
+}
+
+void ChunkRenderer::upload(std::span<u32 const> rebuilt) {
+    auto const chunks = this->mesh.get_chunks();
+
+    bool fits = this->offsets.size() == chunks.size();
+    for (usize i = 0; fits && i < rebuilt.size(); i += 1) {
+        fits = chunks[rebuilt[i]].faces.size() <= this->capacities[rebuilt[i]];
+    }
+    if (!fits) {
+        this->relayout();
+        return;
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, this->face_buffer);
+    for (u32 const chunk : rebuilt) {
+        glBufferSubData(
+            GL_TEXTURE_BUFFER,
+            static_cast<isize>(this->offsets[chunk] * sizeof(u32)),
+            static_cast<isize>(chunks[chunk].faces.size() * sizeof(u32)),
+            chunks[chunk].faces.data()
+        );
+    }
+}
+
+void ChunkRenderer::draw(
+    Life const      &life,
+    CellColor const &color,
+    Camera const    &camera,
+    Stats           &stats
+) {
+    u8 const        count = life.get_chunk_count();
+    std::vector<u8> levels(static_cast<usize>(count) * count * count);
+    for (u32 i = 0; i < levels.size(); i += 1) {
+        f32 const distance =
+            std::max(glm::distance(chunk_center(life, i), camera.eye), 1.0F);
+        f32 const pixels = camera.pixel_scale / distance;
+        f32 const level =
+            std::floor(std::log2(LOD_PIXELS / pixels) + this->lod_bias);
+        levels[i] = static_cast<u8>(
+            std::clamp(level, 0.0F, static_cast<f32>(LOD_LEVELS))
+        );
+    }
+
+    std::vector<u32> rebuilt;
+    {
+        PhaseTimer const timer(stats, Phase::Compaction, life.size());
+        rebuilt = this->mesh.update(life, levels);
+    }
+    {
+        PhaseTimer const timer(stats, Phase::Upload);
+        GpuZone const    gpu(stats, Phase::GpuUpload);
+        this->upload(rebuilt);
+    }
+
+    Frustum const frustum(camera.mvp);
+    auto const    chunks = this->mesh.get_chunks();
+
+    // (squared distance from the eye, chunk) of every visible chunk
+    std::vector<std::pair<f32, u32>> visible;
+    for (u32 i = 0; i < chunks.size(); i += 1) {
+        ChunkFaces const &chunk = chunks[i];
+        if (chunk.faces.empty() ||
+            !frustum.intersects(chunk.lower, chunk.upper) ||
+            this->mesh.is_occluded(i, camera.eye)) {
+            continue;
+        }
+        glm::vec3 const center = (chunk.lower + chunk.upper) * 0.5F;
+        glm::vec3 const offset = center - camera.eye;
+        visible.emplace_back(glm::dot(offset, offset), i);
+    }
+
+    // front to back, so early depth testing discards hidden fragments
+    std::ranges::sort(visible);
+
+    this->program.use();
+    this->color_uniforms.set(color, life);
+    glUniformMatrix4fv(
+        this->mvp_location, 1, 0U, glm::value_ptr(camera.mvp)
+    );
+    glUniform1i(this->faces_location, 0);
+
+    glBindVertexArray(this->VAO);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, this->face_texture);
+
+    std::vector<i32> firsts;
+    std::vector<i32> counts;
+    firsts.reserve(visible.size());
+    counts.reserve(visible.size());
+    GpuZone const gpu(stats, Phase::GpuDraw);
+    for (u8 level = 0; level <= LOD_LEVELS; level += 1) {
+        firsts.clear();
+        counts.clear();
+        for (auto [distance, i] : visible) {
+            if (chunks[i].level != level) {
+                continue;
+            }
+            firsts.push_back(
+                static_cast<i32>(this->offsets[i]) * FACE_VERTICES
+            );
+            counts.push_back(
+                static_cast<i32>(chunks[i].faces.size()) * FACE_VERTICES
+            );
+        }
+        if (firsts.empty()) {
+            continue;
+        }
+
+        glUniform1ui(this->level_location, level);
+        glMultiDrawArrays(
+            GL_TRIANGLES,
+            firsts.data(),
+            counts.data(),
+            static_cast<i32>(firsts.size())
+        );
+    }
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void ChunkRenderer::destroy() {
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->face_buffer);
+    glDeleteTextures(1, &this->face_texture);
+    this->gpu_memory.set(0);
+}
+
+VolumeRenderer::VolumeRenderer(Shader program)
+    : program(program), mvp_location(uniform_location(program, "MVP")),
+      inverse_location(uniform_location(program, "inverse_MVP")),
+      cells_location(uniform_location(program, "cells")),
+      color_uniforms(program) {
+    glGenVertexArrays(1, &this->VAO);
+    glGenTextures(1, &this->cell_texture);
+
+    // integer textures are never filtered, the mips are read by texelFetch
+    glBindTexture(GL_TEXTURE_3D, this->cell_texture);
+    glTexParameteri(
+        GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST
+    );
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, LOD_LEVELS);
+    glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+void VolumeRenderer::upload(Life const &life) {
+    u8 const count = life.get_chunk_count();
+
+    glBindTexture(GL_TEXTURE_3D, this->cell_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (life.get_dimension() != this->dimension) {
+        this->dimension = life.get_dimension();
+        this->stamp     = 0;
+
+        // the padding past the last cell must read as dead
+        u32 const             side = static_cast<u32>(count) * CHUNK_SIZE;
+        std::vector<u8> const zeros(static_cast<usize>(side) * side * side);
+        MemoryAccount const   scratch(Memory::Scratch, zeros.size());
+        usize                 bytes = 0;
+        for (u8 level = 0; level <= LOD_LEVELS; level += 1) {
+            i32 const level_side = static_cast<i32>(side >> level);
+            bytes += static_cast<usize>(level_side) * level_side * level_side;
+            glTexImage3D(
+                GL_TEXTURE_3D,
+                level,
+                GL_R8UI,
+                level_side,
+                level_side,
+                level_side,
+                0,
+                GL_RED_INTEGER,
+                GL_UNSIGNED_BYTE,
+                zeros.data()
+            );
+        }
+        this->gpu_memory.set(bytes);
+    }
+
+    std::vector<glm::uvec3> dirty{};
+    for (u8 cz = 0; cz < count; cz += 1) {
+        for (u8 cy = 0; cy < count; cy += 1) {
+            for (u8 cx = 0; cx < count; cx += 1) {
+                if (life.get_chunk_stamp(cx, cy, cz) > this->stamp) {
+                    dirty.emplace_back(cx, cy, cz);
+                }
+            }
+        }
+    }
+    this->stamp = life.get_generation();
+
+    bool const everything =
+        dirty.size() == static_cast<usize>(count) * count * count;
+    for (u8 level = 0; level <= LOD_LEVELS; level += 1) {
+        u32 const side = life.get_level_dimension(level);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<i32>(side));
+        glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, static_cast<i32>(side));
+
+        // one call per level instead of one per chunk
+        if (everything) {
+            upload_box(life, level, glm::uvec3(0), glm::uvec3(side));
+            continue;
+        }
+
+        u32 const size = CHUNK_SIZE >> level;
+        for (glm::uvec3 const &chunk : dirty) {
+            glm::uvec3 const lower = chunk * size;
+            upload_box(
+                life, level, lower, glm::min(lower + size, glm::uvec3(side))
+            );
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+    glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+void VolumeRenderer::draw(
+    Life const      &life,
+    CellColor const &color,
+    Camera const    &camera,
+    Stats           &stats
+) {
+    {
+        PhaseTimer const timer(stats, Phase::Upload);
+        GpuZone const    gpu(stats, Phase::GpuUpload);
+        this->upload(life);
+    }
+
+    glm::mat4 const inverse = glm::inverse(camera.mvp);
+
+    this->program.use();
+    this->color_uniforms.set(color, life);
+    glUniformMatrix4fv(
+        this->mvp_location, 1, 0U, glm::value_ptr(camera.mvp)
+    );
+    glUniformMatrix4fv(
+        this->inverse_location, 1, 0U, glm::value_ptr(inverse)
+    );
+    glUniform1i(this->cells_location, 0);
+
+    glBindVertexArray(this->VAO);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_3D, this->cell_texture);
+
+    // a single triangle covering the screen, see shader/volume.vert
+    {
+        GpuZone const gpu(stats, Phase::GpuDraw);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    glBindTexture(GL_TEXTURE_3D, 0);
+    glBindVertexArray(0);
+}
+
+void VolumeRenderer::destroy() {
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteTextures(1, &this->cell_texture);
+    this->gpu_memory.set(0);
+}
+
+auto ScaledTarget::bind(glm::ivec2 window, f32 scale) -> glm::ivec2 {
+    glm::ivec2 const size =
+        glm::max(glm::ivec2(glm::vec2(window) * scale), glm::ivec2(1));
+    if (this->framebuffer == 0) {
+        glGenFramebuffers(1, &this->framebuffer);
+        glGenRenderbuffers(1, &this->color);
+        glGenRenderbuffers(1, &this->depth);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer);
+    if (size != this->size) {
+        this->size = size;
+        glBindRenderbuffer(GL_RENDERBUFFER, this->color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y);
+        glBindRenderbuffer(GL_RENDERBUFFER, this->depth);
+        glRenderbufferStorage(
+            GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size.x, size.y
+        );
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        // four bytes of colour and, padded, four of depth per pixel
+        this->gpu_memory.set(static_cast<usize>(size.x) * size.y * 8);
+
+        glFramebufferRenderbuffer(
+            GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->color
+        );
+        glFramebufferRenderbuffer(
+            GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->depth
+        );
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+            GL_FRAMEBUFFER_COMPLETE) {
+            panic("Failed to create framebuffer");
+        }
+    }
+    glViewport(0, 0, size.x, size.y);
+    return size;
+}
+
+void ScaledTarget::resolve(glm::ivec2 window) const {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(
+        0,
+        0,
+        this->size.x,
+        this->size.y,
+        0,
+        0,
+        window.x,
+        window.y,
+        GL_COLOR_BUFFER_BIT,
+        GL_LINEAR
+    );
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, window.x, window.y);
+}
+
+void ScaledTarget::destroy() {
+    glDeleteFramebuffers(1, &this->framebuffer);
+    glDeleteRenderbuffers(1, &this->color);
+    glDeleteRenderbuffers(1, &this->depth);
+    this->gpu_memory.set(0);
+}
+
+} // namespace cell
@@ -1,7 +1,14 @@
+#include <cstdlib>
+#include <filesystem>
+#include <format>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
 
 #include <cell/app.hpp>
 #include <cell/shader.hpp>
@@ -10,84 +17,218 @@
 
 namespace cell {
 
-Shader::Shader(
-    char const *vertex_path, char const *geom_path, char const *fragment_path
-) {
-    std::string vertex_code;
-    std::string geom_code;
-    std::string fragment_code;
-
-    {
-        std::ifstream const vertex_file(vertex_path);
-        std::ifstream const geom_file(geom_path);
-        std::ifstream const fragment_file(fragment_path);
-
-        if (!vertex_file.is_open() || !geom_file.is_open() ||
-            !fragment_file.is_open()) {
-            panic("Could not read shader file");
+namespace {
+constexpr usize MAX_LOG_SIZE = 512;
+
+auto find_source(std::string_view name) -> std::string_view {
+    for (ShaderSource const &source : SHADER_SOURCES) {
+        if (source.name == name) {
+            return source.code;
         }
+    }
+    panic("Unknown shader file {}", name);
+}
 
-        std::stringstream vertex_stream;
-        std::stringstream geom_stream;
-        std::stringstream fragment_stream;
-        vertex_stream << vertex_file.rdbuf();
-        geom_stream << geom_file.rdbuf();
-        fragment_stream << fragment_file.rdbuf();
+// Reads a shader file, replacing every `#include "file"` line with the
+// contents of file.
+auto read_source(std::string_view name) -> std::string {
+    constexpr std::string_view INCLUDE = "#include \"";
+
+    std::istringstream file{std::string(find_source(name))};
+    std::stringstream  source;
+    std::string        line;
+    while (std::getline(file, line)) {
+        if (line.starts_with(INCLUDE) && line.ends_with('"')) {
+            auto const included = line.substr(
+                INCLUDE.size(), line.size() - INCLUDE.size() - 1
+            );
+            source << read_source(included);
+        } else {
+            source << line << '\n';
+        }
+    }
+    return source.str();
+}
 
-        vertex_code   = vertex_stream.str();
-        geom_code     = geom_stream.str();
-        fragment_code = fragment_stream.str();
+// 64 bit FNV-1a, stable across runs unlike std::hash
+constexpr auto hash(u64 seed, std::string_view bytes) -> u64 {
+    u64 value = seed;
+    for (char const byte : bytes) {
+        value ^= static_cast<u8>(byte);
+        value *= 0x100000001B3ULL;
     }
+    return value;
+}
 
-    char const *vertex_code_cstr   = vertex_code.c_str();
-    char const *geom_code_cstr     = geom_code.c_str();
-    char const *fragment_code_cstr = fragment_code.c_str();
+auto gl_string(GLenum name) -> std::string_view {
+    auto const *value = reinterpret_cast<char const *>(glGetString(name));
+    return value == nullptr ? std::string_view() : std::string_view(value);
+}
 
-    int             success      = 0;
-    constexpr usize MAX_LOG_SIZE = 512;
-    std::string     info_log     = std::string(MAX_LOG_SIZE, 0);
+auto binary_cache_enabled() -> bool {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
 
-    u32 const vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vertex_code_cstr, nullptr);
-    glCompileShader(vertex);
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-    if (success == 0) {
-        glGetShaderInfoLog(vertex, MAX_LOG_SIZE, nullptr, info_log.data());
-        panic("Vertex shader compilation failed: {}", info_log);
+// $XDG_CACHE_HOME/cellular/<key>.bin, or under ~/.cache without it
+auto cache_path(u64 key) -> std::optional<std::filesystem::path> {
+    std::filesystem::path base{};
+    if (char const *cache = std::getenv("XDG_CACHE_HOME"); cache != nullptr) {
+        base = cache;
+    } else if (char const *home = std::getenv("HOME"); home != nullptr) {
+        base = std::filesystem::path(home) / ".cache";
+    } else {
+        return std::nullopt;
     }
+    return base / "cellular" / std::format("{:016x}.bin", key);
+}
 
-    u32 const geom = glCreateShader(GL_GEOMETRY_SHADER);
-    glShaderSource(geom, 1, &geom_code_cstr, nullptr);
-    glCompileShader(geom);
-    glGetShaderiv(geom, GL_COMPILE_STATUS, &success);
-    if (success == 0) {
-        glGetShaderInfoLog(geom, MAX_LOG_SIZE, nullptr, info_log.data());
-        panic("Geometry shader compilation failed: {}", info_log);
+// A cached binary holds its GLenum format followed by the program itself.
+auto load_binary(u32 program, u64 key) -> bool {
+    auto const path = cache_path(key);
+    if (!path.has_value()) {
+        return false;
+    }
+    std::ifstream file(path.value(), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    GLenum format = 0;
+    file.read(reinterpret_cast<char *>(&format), sizeof(format));
+    if (file.gcount() != sizeof(format)) {
+        return false;
+    }
+    // read through the buffer, which leaves the state of the stream alone
+    std::vector<char> const binary(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()
+    );
+    if (binary.empty()) {
+        return false;
     }
 
-    u32 const fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fragment_code_cstr, nullptr);
-    glCompileShader(fragment);
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+    // a driver update may reject an old binary, which is then rebuilt
+    glProgramBinary(
+        program, format, binary.data(), static_cast<GLsizei>(binary.size())
+    );
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success != 0;
+}
+
+void save_binary(u32 program, u64 key) {
+    auto const path = cache_path(key);
+    if (!path.has_value()) {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    GLenum            format = 0;
+    std::vector<char> binary(static_cast<usize>(length));
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    // the cache only saves time, so failing to write it is not an error
+    std::error_code error{};
+    std::filesystem::create_directories(path->parent_path(), error);
+    std::ofstream file(path.value(), std::ios::binary);
+    file.write(reinterpret_cast<char const *>(&format), sizeof(format));
+    file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+}
+
+auto compile(GLenum type, std::string const &code) -> u32 {
+    char const *code_cstr = code.c_str();
+    u32 const   shader    = glCreateShader(type);
+    glShaderSource(shader, 1, &code_cstr, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+void check_compile(u32 shader, std::string_view stage) {
+    int success = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (success == 0) {
-        glGetShaderInfoLog(fragment, MAX_LOG_SIZE, nullptr, info_log.data());
-        panic("Fragment shader compilation failed: {}", info_log);
+        std::string info_log = std::string(MAX_LOG_SIZE, 0);
+        glGetShaderInfoLog(shader, MAX_LOG_SIZE, nullptr, info_log.data());
+        panic("{} shader compilation failed: {}", stage, info_log);
     }
+}
+} // namespace
+
+void enable_parallel_compile() {
+    using MaxShaderCompilerThreads = void (*)(GLuint);
+
+    if (glfwExtensionSupported("GL_KHR_parallel_shader_compile") == 0) {
+        return;
+    }
+    auto const max_threads = reinterpret_cast<MaxShaderCompilerThreads>(
+        glfwGetProcAddress("glMaxShaderCompilerThreadsKHR")
+    );
+    if (max_threads != nullptr) {
+        // as many threads as the driver sees fit
+        max_threads(0xFFFFFFFFU);
+    }
+}
+
+Shader::Shader(std::string_view vertex_name, std::string_view fragment_name) {
+    std::string const vertex_code   = read_source(vertex_name);
+    std::string const fragment_code = read_source(fragment_name);
 
     this->id = glCreateProgram();
-    glAttachShader(this->id, vertex);
-    glAttachShader(this->id, geom);
-    glAttachShader(this->id, fragment);
+
+    bool const cached = binary_cache_enabled();
+    if (cached) {
+        u64 key   = 0xCBF29CE484222325ULL;
+        key       = hash(key, gl_string(GL_VENDOR));
+        key       = hash(key, gl_string(GL_RENDERER));
+        key       = hash(key, gl_string(GL_VERSION));
+        key       = hash(key, vertex_code);
+        this->key = hash(key, fragment_code);
+        if (load_binary(this->id, this->key)) {
+            return;
+        }
+        glProgramParameteri(
+            this->id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE
+        );
+    }
+
+    // no status is queried here, that would wait for the compiler
+    this->vertex   = compile(GL_VERTEX_SHADER, vertex_code);
+    this->fragment = compile(GL_FRAGMENT_SHADER, fragment_code);
+    glAttachShader(this->id, this->vertex);
+    glAttachShader(this->id, this->fragment);
     glLinkProgram(this->id);
+}
+
+void Shader::wait() {
+    if (this->vertex == 0) {
+        return;
+    }
+
+    int success = 0;
     glGetProgramiv(this->id, GL_LINK_STATUS, &success);
     if (success == 0) {
+        check_compile(this->vertex, "Vertex");
+        check_compile(this->fragment, "Fragment");
+        std::string info_log = std::string(MAX_LOG_SIZE, 0);
         glGetProgramInfoLog(this->id, MAX_LOG_SIZE, nullptr, info_log.data());
         panic("Shader linking failed: {}", info_log);
     }
 
-    glDeleteShader(vertex);
-    glDeleteShader(geom);
-    glDeleteShader(fragment);
+    glDetachShader(this->id, this->vertex);
+    glDetachShader(this->id, this->fragment);
+    glDeleteShader(this->vertex);
+    glDeleteShader(this->fragment);
+    this->vertex   = 0;
+    this->fragment = 0;
+
+    if (this->key != 0) {
+        save_binary(this->id, this->key);
+    }
 }
 
 auto Shader::get_id() const -> u32 {
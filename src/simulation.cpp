@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include <cell/simulation.hpp>
+#include <cell/trace.hpp>
+
+namespace cell {
+
+void init_life(Life &life, LifeRule const &rule, bool full_init) {
+    if (full_init) {
+        life.init_full_random(rule.state_count, rule.start_dead_chance);
+    } else if (life.get_dimension() <= 44) {
+        f64 const dead_chance = rule.start_dead_chance * 0.7;
+        life.init_full_random(rule.state_count, dead_chance);
+    } else {
+        f64 const dead_chance = rule.start_dead_chance;
+        life.init_center_random(rule.state_count, dead_chance);
+    }
+}
+
+Simulation::Simulation(u8 dimension, LifeRule rule, bool full_init)
+    : snapshots(Life(dimension).get_view()), life(Life(dimension)),
+      rule(std::move(rule)),
+      dimension(dimension), full_init(full_init) {
+}
+
+auto Simulation::estimate_memory(u8 dimension, u8 state_count)
+    -> LifeMemory {
+    // the world being updated and the views in the three slots of snapshots
+    LifeMemory const life = Life::estimate_memory(dimension, state_count);
+    LifeMemory const view = Life::estimate_view_memory(dimension);
+    return {
+        .grid    = life.grid + (view.grid * 3),
+        .scratch = life.scratch + (view.scratch * 3),
+    };
+}
+
+void Simulation::start() {
+    this->thread = std::jthread([this](std::stop_token const &stop) {
+        this->run(stop);
+    });
+}
+
+auto Simulation::apply_pending() -> std::optional<LifeRule> {
+    LifeRule rule{};
+    u8       dimension = 0;
+    bool     full_init = false;
+    {
+        std::scoped_lock const lock(this->mutex);
+        if (!this->pending) {
+            return this->rule;
+        }
+        rule          = this->rule;
+        dimension     = this->dimension;
+        full_init     = this->full_init;
+        this->pending = false;
+    }
+
+    if (dimension != this->life.get_dimension()) {
+        this->life.resize(dimension);
+    }
+    init_life(this->life, rule, full_init);
+    this->publish();
+    return std::nullopt;
+}
+
+void Simulation::publish() {
+    TraceZone const zone("Simulation::publish");
+    // only what the renderers read, into storage of the same size
+    this->life.copy_view_to(this->snapshots.get_back());
+    this->snapshots.publish();
+}
+
+void Simulation::add_update(std::chrono::nanoseconds duration) {
+    std::scoped_lock const lock(this->mutex);
+    this->updates.record(static_cast<u64>(duration.count()));
+}
+
+void Simulation::step() {
+    std::optional<LifeRule> const rule = this->apply_pending();
+    if (!rule.has_value()) {
+        return;
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    this->life.update(rule.value());
+    this->add_update(std::chrono::steady_clock::now() - start);
+    this->publish();
+}
+
+void Simulation::advance(f64 budget) {
+    auto const start = std::chrono::steady_clock::now();
+    auto const end =
+        start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<f64>(budget)
+                );
+
+    std::optional<LifeRule> const rule = this->apply_pending();
+    if (!rule.has_value()) {
+        this->slice_time = {};
+        return;
+    }
+    u32 rate = 0;
+    {
+        std::scoped_lock const lock(this->mutex);
+        rate = this->throttled_rate();
+    }
+
+    auto now = start;
+    while (now < end) {
+        if (!this->life.is_updating() && rate != 0) {
+            // the next generation is not due yet
+            if (now < this->due) {
+                break;
+            }
+            this->due = now + std::chrono::duration_cast<
+                                  std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<f64>(1.0 / rate)
+                              );
+        }
+
+        bool const done = this->life.advance(rule.value(), 1);
+        auto const last = now;
+        now             = std::chrono::steady_clock::now();
+        this->slice_time += now - last;
+        if (done) {
+            this->add_update(std::exchange(this->slice_time, {}));
+            this->publish();
+        }
+    }
+}
+
+void Simulation::run(std::stop_token const &stop) {
+    set_trace_thread_name("simulation");
+    while (!stop.stop_requested()) {
+        auto const start = std::chrono::steady_clock::now();
+        this->step();
+
+        std::unique_lock lock(this->mutex);
+        u32 const        rate = this->throttled_rate();
+        if (rate == 0) {
+            continue;
+        }
+        auto const period = std::chrono::duration_cast<
+            std::chrono::steady_clock::duration>(
+            std::chrono::duration<f64>(1.0 / rate)
+        );
+        // a restart is not worth waiting for
+        this->changed.wait_until(lock, stop, start + period, [this]() {
+            return this->pending;
+        });
+    }
+}
+
+auto Simulation::read() -> Life const & {
+    return this->snapshots.read();
+}
+
+void Simulation::set_rule(LifeRule const &rule, bool full_init) {
+    {
+        std::scoped_lock const lock(this->mutex);
+        this->rule      = rule;
+        this->full_init = full_init;
+        this->pending   = true;
+    }
+    this->changed.notify_all();
+}
+
+void Simulation::resize(u8 dimension) {
+    {
+        std::scoped_lock const lock(this->mutex);
+        this->dimension = dimension;
+        this->pending   = true;
+    }
+    this->changed.notify_all();
+}
+
+void Simulation::restart() {
+    {
+        std::scoped_lock const lock(this->mutex);
+        this->pending = true;
+    }
+    this->changed.notify_all();
+}
+
+void Simulation::set_rate(u32 rate) {
+    std::scoped_lock const lock(this->mutex);
+    this->rate = std::min(rate, MAX_GENERATION_RATE);
+}
+
+auto Simulation::get_rate() -> u32 {
+    std::scoped_lock const lock(this->mutex);
+    return this->rate;
+}
+
+void Simulation::set_throttle(u8 throttle) {
+    std::scoped_lock const lock(this->mutex);
+    this->throttle = throttle;
+}
+
+auto Simulation::throttled_rate() const -> u32 {
+    if (this->throttle == 0) {
+        return this->rate;
+    }
+    u32 const rate = this->rate == 0 ? MAX_GENERATION_RATE : this->rate;
+    return std::max<u32>(rate >> this->throttle, 1);
+}
+
+auto Simulation::get_dimension() -> u8 {
+    std::scoped_lock const lock(this->mutex);
+    return this->dimension;
+}
+
+auto Simulation::take_updates() -> Histogram {
+    std::scoped_lock const lock(this->mutex);
+    return std::exchange(this->updates, Histogram{});
+}
+
+} // namespace cell
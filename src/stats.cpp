@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <cell/stats.hpp>
+#include <util/util.hpp>
+
+namespace cell {
+
+namespace {
+auto milliseconds(f64 nanoseconds) -> f64 {
+    return nanoseconds / 1e6;
+}
+
+// Metrics of the events of a phase, in the CSV columns after the latencies.
+constexpr std::array<std::string_view, 4> COUNTER_METRICS = {
+    "ipc", "cycles_per_cell", "bytes_per_cell", "stalled",
+};
+
+// Metrics of the events of a phase, as name and value pairs, leaving out
+// those the machine did not count.
+auto counter_metrics(CounterSample const &sample)
+    -> std::vector<std::pair<std::string_view, f64>> {
+    std::vector<std::pair<std::string_view, f64>> metrics{};
+    if (!sample.has(Counter::Cycles)) {
+        return metrics;
+    }
+    if (sample.has(Counter::Instructions)) {
+        metrics.emplace_back("ipc", sample.get_ipc());
+    }
+    if (sample.get_cells() != 0) {
+        metrics.emplace_back("cycles_per_cell", sample.get_cycles_per_cell());
+        if (sample.has(Counter::CacheMisses)) {
+            metrics.emplace_back("bytes_per_cell", sample.get_bytes_per_cell());
+        }
+    }
+    if (sample.has(Counter::StalledCycles)) {
+        metrics.emplace_back("stalled", sample.get_stalled());
+    }
+    return metrics;
+}
+} // namespace
+
+void Histogram::merge(Histogram const &other) {
+    for (u32 i = 0; i < BUCKETS; i += 1) {
+        this->counts[i] += other.counts[i];
+    }
+    this->count += other.count;
+    this->sum += other.sum;
+    this->max = std::max(this->max, other.max);
+}
+
+void Histogram::clear() {
+    *this = Histogram{};
+}
+
+auto Histogram::percentile(f64 fraction) const -> u64 {
+    if (this->count == 0) {
+        return 0;
+    }
+    auto const rank = std::max<u64>(
+        static_cast<u64>(std::ceil(fraction * static_cast<f64>(this->count))),
+        1
+    );
+
+    u64 seen = 0;
+    for (u32 i = 0; i < BUCKETS; i += 1) {
+        seen += this->counts[i];
+        if (seen >= rank) {
+            return std::min(highest(i), this->max);
+        }
+    }
+    return this->max;
+}
+
+void Stats::merge(Phase phase, Histogram const &histogram) {
+    this->recent[static_cast<usize>(phase)].merge(histogram);
+}
+
+void Stats::take_counters() {
+    for (usize i = 0; i < PHASE_COUNT; i += 1) {
+        this->recent_counters[i].merge(
+            cell::take_counters(static_cast<Phase>(i))
+        );
+    }
+}
+
+void Stats::flush() {
+    for (usize i = 0; i < PHASE_COUNT; i += 1) {
+        this->total[i].merge(this->recent[i]);
+        this->recent[i].clear();
+        this->total_counters[i].merge(this->recent_counters[i]);
+        this->recent_counters[i] = CounterSample{};
+    }
+}
+
+void Stats::print() const {
+    for (usize i = 0; i < PHASE_COUNT; i += 1) {
+        Histogram const &histogram = this->total[i];
+        if (histogram.get_count() == 0) {
+            continue;
+        }
+        eprintln(
+            "{}: mean {} ms, p50 {} ms, p99 {} ms, p999 {} ms, max {} ms",
+            PHASE_NAMES[i],
+            milliseconds(histogram.get_mean()),
+            milliseconds(static_cast<f64>(histogram.percentile(0.5))),
+            milliseconds(static_cast<f64>(histogram.percentile(0.99))),
+            milliseconds(static_cast<f64>(histogram.percentile(0.999))),
+            milliseconds(static_cast<f64>(histogram.get_max()))
+        );
+
+        CounterSample const &sample = this->total_counters[i];
+        std::string          line{};
+        for (auto const &[name, value] : counter_metrics(sample)) {
+            line += std::format(
+                "{}{} {}", line.empty() ? "" : ", ", name, value
+            );
+        }
+        if (sample.has(Counter::CacheMisses) && histogram.get_count() != 0) {
+            // bytes per nanosecond of the phase
+            f64 const bytes = static_cast<f64>(
+                sample.get(Counter::CacheMisses) * CACHE_LINE_SIZE
+            );
+            line += std::format(
+                ", {} GB/s",
+                bytes / (histogram.get_mean() *
+                         static_cast<f64>(histogram.get_count()))
+            );
+        }
+        if (!line.empty()) {
+            eprintln("    {}", line);
+        }
+    }
+}
+
+StatsWriter::StatsWriter(std::filesystem::path const &path)
+    : stream(path), csv(path.extension() == ".csv") {
+    if (!this->stream.is_open()) {
+        panic("Could not write stats file {}", path.string());
+    }
+    if (this->csv) {
+        this->stream << "time,generation,phase,count,mean,p50,p99,p999,max";
+        for (std::string_view const column : COUNTER_METRICS) {
+            this->stream << ',' << column;
+        }
+        this->stream << '\n';
+    }
+}
+
+void StatsWriter::write(Stats const &stats, f64 time, u64 generation) {
+    std::string line =
+        this->csv ? std::string()
+                  : std::format(
+                        R"({{"time":{},"generation":{})", time, generation
+                    );
+
+    for (usize i = 0; i < PHASE_COUNT; i += 1) {
+        Histogram const &histogram = stats.get_recent(static_cast<Phase>(i));
+        f64 const        mean      = milliseconds(histogram.get_mean());
+        f64 const        p50 =
+            milliseconds(static_cast<f64>(histogram.percentile(0.5)));
+        f64 const p99 =
+            milliseconds(static_cast<f64>(histogram.percentile(0.99)));
+        f64 const p999 =
+            milliseconds(static_cast<f64>(histogram.percentile(0.999)));
+        f64 const max = milliseconds(static_cast<f64>(histogram.get_max()));
+        auto const metrics =
+            counter_metrics(stats.get_recent_counters(static_cast<Phase>(i)));
+
+        if (this->csv) {
+            line += std::format(
+                "{},{},{},{},{},{},{},{},{}",
+                time,
+                generation,
+                PHASE_NAMES[i],
+                histogram.get_count(),
+                mean,
+                p50,
+                p99,
+                p999,
+                max
+            );
+            // an empty column for each metric that was not counted
+            for (std::string_view const column : COUNTER_METRICS) {
+                auto const metric = std::ranges::find(
+                    metrics, column, &std::pair<std::string_view, f64>::first
+                );
+                line += metric == metrics.end()
+                            ? std::string(",")
+                            : std::format(",{}", metric->second);
+            }
+            line += '\n';
+        } else {
+            line += std::format(
+                R"(,"{}":{{"count":{},"mean":{},"p50":{},"p99":{},)"
+                R"("p999":{},"max":{})",
+                PHASE_NAMES[i],
+                histogram.get_count(),
+                mean,
+                p50,
+                p99,
+                p999,
+                max
+            );
+            for (auto const &[name, value] : metrics) {
+                line += std::format(R"(,"{}":{})", name, value);
+            }
+            line += '}';
+        }
+    }
+    if (!this->csv) {
+        line += "}\n";
+    }
+
+    // whole lines at a time, so a run that is killed leaves a readable file
+    this->stream << line << std::flush;
+}
+
+} // namespace cell
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cell/trace.hpp>
+#include <util/util.hpp>
+
+namespace cell {
+
+namespace {
+// A zone, in nanoseconds since tracing started.
+struct TraceEvent {
+    std::string_view name;
+    i64              start;
+    i64              duration;
+};
+
+// Where a ring keeps a zone. A dump reads the slots while their thread
+// writes them, so every field is a relaxed atomic, and a zone torn by a
+// write is one dump_trace drops rather than undefined behaviour.
+struct TraceSlot {
+    std::atomic<char const *> name_data;
+    std::atomic<usize>        name_size;
+    std::atomic<i64>          start;
+    std::atomic<i64>          duration;
+
+    void write(TraceEvent const &event) {
+        this->name_data.store(event.name.data(), std::memory_order_relaxed);
+        this->name_size.store(event.name.size(), std::memory_order_relaxed);
+        this->start.store(event.start, std::memory_order_relaxed);
+        this->duration.store(event.duration, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto read() const -> TraceEvent {
+        return {
+            .name = std::string_view(
+                this->name_data.load(std::memory_order_relaxed),
+                this->name_size.load(std::memory_order_relaxed)
+            ),
+            .start    = this->start.load(std::memory_order_relaxed),
+            .duration = this->duration.load(std::memory_order_relaxed),
+        };
+    }
+};
+
+// Zones of one thread. Only the thread owning it writes, publishing each
+// zone by advancing head, so a dump reads the ring without stopping the
+// thread and drops the zones overwritten while it read.
+struct TraceRing {
+    std::array<TraceSlot, TRACE_CAPACITY> events;
+    std::atomic<u64>                      head;
+    // tid of the dump
+    u32                                   id;
+    // guarded by the mutex of the registry
+    std::string                           name;
+};
+
+struct Registry {
+    std::mutex                              mutex;
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    // rings of threads that exited
+    std::vector<TraceRing *>                free;
+    std::filesystem::path                   path;
+};
+
+std::atomic<bool>                     tracing = false;
+// set before tracing
+std::chrono::steady_clock::time_point epoch;
+
+auto registry() -> Registry & {
+    static Registry registry{};
+    return registry;
+}
+
+// Gives the ring of a thread back when it exits.
+struct RingHandle {
+    TraceRing *ring = nullptr;
+
+    RingHandle() = default;
+    ~RingHandle() {
+        if (this->ring != nullptr) {
+            Registry              &registry = cell::registry();
+            std::scoped_lock const lock(registry.mutex);
+            registry.free.push_back(this->ring);
+        }
+    }
+
+    RingHandle(RingHandle const &)                     = delete;
+    RingHandle(RingHandle &&)                          = delete;
+    auto operator=(RingHandle const &) -> RingHandle & = delete;
+    auto operator=(RingHandle &&) -> RingHandle &      = delete;
+};
+
+auto thread_ring() -> TraceRing & {
+    thread_local RingHandle handle{};
+    if (handle.ring != nullptr) {
+        return *handle.ring;
+    }
+
+    Registry              &registry = cell::registry();
+    std::scoped_lock const lock(registry.mutex);
+    if (!registry.free.empty()) {
+        handle.ring = registry.free.back();
+        registry.free.pop_back();
+    } else {
+        auto ring   = std::make_unique<TraceRing>();
+        ring->id    = static_cast<u32>(registry.rings.size() + 1);
+        ring->name  = std::format("thread {}", ring->id);
+        handle.ring = ring.get();
+        registry.rings.push_back(std::move(ring));
+    }
+    return *handle.ring;
+}
+
+auto since_epoch() -> i64 {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - epoch
+    )
+        .count();
+}
+
+// nanoseconds as the microseconds of the trace-event format
+auto microseconds(i64 nanoseconds) -> f64 {
+    return static_cast<f64>(nanoseconds) / 1e3;
+}
+} // namespace
+
+void start_tracing(std::filesystem::path const &path) {
+    {
+        Registry              &registry = cell::registry();
+        std::scoped_lock const lock(registry.mutex);
+        registry.path = path;
+    }
+    epoch = std::chrono::steady_clock::now();
+    tracing.store(true, std::memory_order_release);
+}
+
+auto is_tracing() -> bool {
+    return tracing.load(std::memory_order_acquire);
+}
+
+void set_trace_thread_name(std::string_view name) {
+    if (!is_tracing()) {
+        return;
+    }
+    TraceRing             &ring     = thread_ring();
+    Registry              &registry = cell::registry();
+    std::scoped_lock const lock(registry.mutex);
+    ring.name = name;
+}
+
+void dump_trace() {
+    if (!is_tracing()) {
+        return;
+    }
+
+    // formatted without the lock, so threads starting meanwhile never wait
+    // for the file
+    std::vector<std::pair<TraceRing *, std::string>> rings{};
+    std::filesystem::path                            path{};
+    {
+        Registry              &registry = cell::registry();
+        std::scoped_lock const lock(registry.mutex);
+        for (auto const &ring : registry.rings) {
+            rings.emplace_back(ring.get(), ring->name);
+        }
+        path = registry.path;
+    }
+
+    std::ofstream stream(path);
+    if (!stream.is_open()) {
+        eprintln("trace: could not write {}", path.string());
+        return;
+    }
+
+    std::string out = R"({"displayTimeUnit":"ms","traceEvents":[)";
+    usize       zones = 0;
+    for (auto const &[ring, name] : rings) {
+        if (ring != rings.front().first) {
+            out += ',';
+        }
+        out += std::format(
+            R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},)"
+            R"("args":{{"name":"{}"}}}})",
+            ring->id,
+            name
+        );
+
+        u64 const head = ring->head.load(std::memory_order_acquire);
+        u64 const tail = head > TRACE_CAPACITY ? head - TRACE_CAPACITY : 0;
+        std::vector<TraceEvent> events{};
+        events.reserve(head - tail);
+        for (u64 i = tail; i < head; i += 1) {
+            events.push_back(ring->events[i % TRACE_CAPACITY].read());
+        }
+
+        // the thread kept recording while the zones were copied, over the
+        // oldest of them, and may be writing the slot of head itself, which
+        // held the zone TRACE_CAPACITY before it; the fence keeps the copies
+        // above this load
+        std::atomic_thread_fence(std::memory_order_acquire);
+        u64 const last  = ring->head.load(std::memory_order_relaxed);
+        u64 const valid =
+            last >= TRACE_CAPACITY ? last - TRACE_CAPACITY + 1 : 0;
+        for (u64 i = std::max(tail, valid); i < head; i += 1) {
+            TraceEvent const &event = events[i - tail];
+            out += std::format(
+                R"(,{{"name":"{}","ph":"X","pid":1,"tid":{},"ts":{},)"
+                R"("dur":{}}})",
+                event.name,
+                ring->id,
+                microseconds(event.start),
+                microseconds(event.duration)
+            );
+            zones += 1;
+        }
+    }
+    out += "]}\n";
+    stream << out;
+
+    eprintln("trace: {} zones written to {}", zones, path.string());
+}
+
+TraceZone::TraceZone(std::string_view name)
+    : name(name), start(is_tracing() ? since_epoch() : -1) {
+}
+
+TraceZone::~TraceZone() {
+    if (this->start < 0) {
+        return;
+    }
+    i64 const  end  = since_epoch();
+    TraceRing &ring = thread_ring();
+
+    u64 const head = ring.head.load(std::memory_order_relaxed);
+    ring.events[head % TRACE_CAPACITY].write({
+        .name     = this->name,
+        .start    = this->start,
+        .duration = end - this->start,
+    });
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+} // namespace cell